@@ -0,0 +1,118 @@
+#include "BiquadFilter.h"
+
+// Same formulas as juce::dsp::IIR::ArrayCoefficients, in SampleType
+template <typename SampleType>
+typename BiquadFilter<SampleType>::Coefficients
+BiquadFilter<SampleType>::Coefficients::makeHighPass(double sampleRate,
+                                                     SampleType frequency,
+                                                     SampleType q) {
+  jassert(frequency > 0 && frequency <= (SampleType)(sampleRate * 0.5));
+
+  const auto n = std::tan(juce::MathConstants<SampleType>::pi * frequency /
+                          (SampleType)sampleRate);
+  const auto nSquared = n * n;
+  const auto invQ = 1 / q;
+  const auto c1 = 1 / (1 + invQ * n + nSquared);
+
+  Coefficients c;
+  c.b0 = c1;
+  c.b1 = c1 * -2;
+  c.b2 = c1;
+  c.a1 = c1 * 2 * (nSquared - 1);
+  c.a2 = c1 * (1 - invQ * n + nSquared);
+  return c;
+}
+
+template <typename SampleType>
+typename BiquadFilter<SampleType>::Coefficients
+BiquadFilter<SampleType>::Coefficients::makeBandPass(double sampleRate,
+                                                     SampleType frequency,
+                                                     SampleType q) {
+  jassert(frequency > 0 && frequency <= (SampleType)(sampleRate * 0.5));
+
+  const auto n = 1 / std::tan(juce::MathConstants<SampleType>::pi *
+                              frequency / (SampleType)sampleRate);
+  const auto nSquared = n * n;
+  const auto invQ = 1 / q;
+  const auto c1 = 1 / (1 + invQ * n + nSquared);
+
+  Coefficients c;
+  c.b0 = c1 * n * invQ;
+  c.b1 = 0;
+  c.b2 = -c1 * n * invQ;
+  c.a1 = c1 * 2 * (1 - nSquared);
+  c.a2 = c1 * (1 - invQ * n + nSquared);
+  return c;
+}
+
+template <typename SampleType>
+void BiquadFilter<SampleType>::prepare(int numChannels, int maxBlockSize) {
+  auto numGroups = (juce::jmax(1, numChannels) + numLanes - 1) / numLanes;
+  states.assign((size_t)numGroups, State());
+
+  // Needed whenever a call passes fewer channels than fill the last group,
+  // which can happen with any prepared channel count
+  silence.assign((size_t)juce::jmax(1, maxBlockSize), SampleType(0));
+  discard.assign((size_t)juce::jmax(1, maxBlockSize), SampleType(0));
+}
+
+template <typename SampleType> void BiquadFilter<SampleType>::reset() {
+  std::fill(states.begin(), states.end(), State());
+}
+
+template <typename SampleType>
+void BiquadFilter<SampleType>::getGroupInputs(
+    int group, const SampleType *const *channels, int numChannels,
+    int startSample, const SampleType *(&inputs)[numLanes]) const noexcept {
+  for (int l = 0; l < numLanes; ++l) {
+    auto ch = group * numLanes + l;
+    inputs[l] = ch < numChannels ? channels[ch] + startSample : silence.data();
+  }
+}
+
+template <typename SampleType>
+void BiquadFilter<SampleType>::process(SampleType *const *channels,
+                                       int numChannels,
+                                       int numSamples) noexcept {
+  numChannels = juce::jmin(numChannels, getNumGroups() * numLanes);
+  jassert(numSamples <= (int)silence.size());
+
+  const auto c = coefficients;
+
+  for (int group = 0; group * numLanes < numChannels; ++group) {
+    const SampleType *in[numLanes];
+    SampleType *out[numLanes];
+    getGroupInputs(group, channels, numChannels, 0, in);
+    for (int l = 0; l < numLanes; ++l) {
+      auto ch = group * numLanes + l;
+      out[l] = ch < numChannels ? channels[ch] : discard.data();
+    }
+
+    // State lives in registers for the whole block
+    auto state = states[(size_t)group];
+    for (int i = 0; i < numSamples; ++i) {
+      Lanes x;
+      for (int l = 0; l < numLanes; ++l)
+        x[(size_t)l] = in[l][i];
+
+      auto y = processSample(c, state, x);
+
+      for (int l = 0; l < numLanes; ++l)
+        out[l][i] = y[(size_t)l];
+    }
+
+    snapToZero(state);
+    states[(size_t)group] = state;
+  }
+}
+
+template <typename SampleType>
+void BiquadFilter<SampleType>::snapToZero(State &s) noexcept {
+  for (int l = 0; l < numLanes; ++l) {
+    JUCE_SNAP_TO_ZERO(s.s1[(size_t)l]);
+    JUCE_SNAP_TO_ZERO(s.s2[(size_t)l]);
+  }
+}
+
+template class BiquadFilter<float>;
+template class BiquadFilter<double>;
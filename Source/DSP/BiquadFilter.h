@@ -0,0 +1,84 @@
+#pragma once
+#include <JuceHeader.h>
+
+// Second-order IIR filter (transposed direct form II) with its own state per
+// channel, for the CoreProtect band-pass and the saturation high-pass.
+//
+// Channels run side by side as lanes: a group of numLanes channels (one
+// 128-bit register, 4 floats or 2 doubles) is filtered together, so the
+// recursions of the channels overlap instead of running one after another
+// and the lane loops vectorize. Lanes past the last channel read silence.
+// The arithmetic matches juce::dsp::IIR::Filter, as do the coefficient
+// formulas. Coefficients are plain values, set without allocating.
+// Instantiated for float and double in BiquadFilter.cpp.
+template <typename SampleType> class BiquadFilter {
+public:
+  static constexpr int numLanes = 16 / (int)sizeof(SampleType);
+  using Lanes = std::array<SampleType, numLanes>;
+
+  // Normalised (a0 = 1)
+  struct Coefficients {
+    SampleType b0 = 1, b1 = 0, b2 = 0, a1 = 0, a2 = 0;
+
+    static Coefficients makeHighPass(double sampleRate, SampleType frequency,
+                                     SampleType q = SampleType(
+                                         juce::MathConstants<double>::sqrt2 /
+                                         2.0));
+    static Coefficients makeBandPass(double sampleRate, SampleType frequency,
+                                     SampleType q);
+  };
+
+  // Filter state of one lane group
+  struct alignas(16) State {
+    Lanes s1{}, s2{};
+  };
+
+  void prepare(int numChannels, int maxBlockSize);
+  void reset();
+
+  void setCoefficients(const Coefficients &newCoefficients) {
+    coefficients = newCoefficients;
+  }
+  const Coefficients &getCoefficients() const { return coefficients; }
+
+  // Filters numSamples of each channel in place. No more channels or
+  // samples than prepared.
+  void process(SampleType *const *channels, int numChannels,
+               int numSamples) noexcept;
+
+  // For callers with their own per-sample loop: copy a group's state out,
+  // run processSample() on the copy and store it back.
+  int getNumGroups() const { return (int)states.size(); }
+  State getState(int group) const { return states[(size_t)group]; }
+  void setState(int group, const State &state) {
+    states[(size_t)group] = state;
+  }
+
+  // The group's channels from startSample on; lanes without a channel get
+  // silence
+  void getGroupInputs(int group, const SampleType *const *channels,
+                      int numChannels, int startSample,
+                      const SampleType *(&inputs)[numLanes]) const noexcept;
+
+  static Lanes processSample(const Coefficients &c, State &s,
+                             const Lanes &x) noexcept {
+    Lanes y;
+    for (int l = 0; l < numLanes; ++l) {
+      y[(size_t)l] = c.b0 * x[(size_t)l] + s.s1[(size_t)l];
+      s.s1[(size_t)l] =
+          c.b1 * x[(size_t)l] - c.a1 * y[(size_t)l] + s.s2[(size_t)l];
+      s.s2[(size_t)l] = c.b2 * x[(size_t)l] - c.a2 * y[(size_t)l];
+    }
+    return y;
+  }
+
+  // Flushes tiny state values to zero, like JUCE's filters after each block
+  static void snapToZero(State &s) noexcept;
+
+private:
+  Coefficients coefficients;
+  std::vector<State> states; // one per lane group
+
+  // Read by lanes without a channel, and written by them in process()
+  std::vector<SampleType> silence, discard;
+};
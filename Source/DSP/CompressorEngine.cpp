@@ -1,55 +1,654 @@
 #include "CompressorEngine.h"
 
-CompressorEngine::CompressorEngine() {}
+// Copies numSamples into/out of a circular buffer starting at pos
+template <typename SampleType>
+static void writeToRing(SampleType *ring, int ringSize, int pos,
+                        const SampleType *src, int numSamples) {
+  auto first = juce::jmin(numSamples, ringSize - pos);
+  juce::FloatVectorOperations::copy(ring + pos, src, first);
+  juce::FloatVectorOperations::copy(ring, src + first, numSamples - first);
+}
+
+template <typename SampleType>
+static void readFromRing(const SampleType *ring, int ringSize, int pos,
+                         SampleType *dest, int numSamples) {
+  auto first = juce::jmin(numSamples, ringSize - pos);
+  juce::FloatVectorOperations::copy(dest, ring + pos, first);
+  juce::FloatVectorOperations::copy(dest + first, ring, numSamples - first);
+}
+
+// level[i] = max(level[i], |x[i]|) over numLanes channels starting at
+// firstChannel. The channel loop is unrolled, the sample loop vectorizes.
+template <size_t numLanes, typename SampleType>
+static void maxAbsInto(SampleType *level,
+                       const juce::dsp::AudioBlock<SampleType> &block,
+                       size_t firstChannel) {
+  const SampleType *in[numLanes];
+  for (size_t k = 0; k < numLanes; ++k)
+    in[k] = block.getChannelPointer(firstChannel + k);
+
+  const auto numSamples = block.getNumSamples();
+  for (size_t i = 0; i < numSamples; ++i) {
+    auto m = level[i];
+    for (size_t k = 0; k < numLanes; ++k)
+      m = std::max(m, std::abs(in[k][i]));
+    level[i] = m;
+  }
+}
+
+// x[i] *= gain[i] over numLanes channels starting at firstChannel
+template <size_t numLanes, typename SampleType>
+static void multiplyInto(juce::dsp::AudioBlock<SampleType> &block,
+                         size_t firstChannel, const SampleType *gain) {
+  SampleType *out[numLanes];
+  for (size_t k = 0; k < numLanes; ++k)
+    out[k] = block.getChannelPointer(firstChannel + k);
 
-void CompressorEngine::prepare(double sr, int samplesPerBlock) {
+  const auto numSamples = block.getNumSamples();
+  for (size_t i = 0; i < numSamples; ++i) {
+    auto g = gain[i];
+    for (size_t k = 0; k < numLanes; ++k)
+      out[k][i] *= g;
+  }
+}
+
+template <typename SampleType>
+CompressorEngine<SampleType>::CompressorEngine() {}
+
+template <typename SampleType>
+void CompressorEngine<SampleType>::prepare(double sr, int samplesPerBlock,
+                                           int numChannels) {
   sampleRate = sr;
-  envelope = 0.0f;
+  envelope = 0;
+  slowEnvelope = 0;
+
+  maxBlockSize = juce::jmax(1, samplesPerBlock);
+  detectorBuffer.assign((size_t)maxBlockSize, SampleType(0));
+  gainBuffer.assign((size_t)maxBlockSize, SampleType(0));
+  thresholdLog2.prepare(sampleRate, maxBlockSize);
+
+  // Force the time constants to be recomputed at the new sample rate
+  coeffAttackMs = coeffReleaseMs = -1.0f;
+
+  maxLookaheadSamples = (int)std::ceil(maxLookaheadMs * 0.001 * sampleRate);
+  peakWindow.prepare(maxLookaheadSamples + 1);
+  lookaheadBuffer.setSize(juce::jmax(1, numChannels),
+                          maxLookaheadSamples + maxBlockSize);
+
+  // Re-apply the current setting at the new sample rate
+  fadeLength = juce::jmax(1, juce::roundToInt(lookaheadFadeMs * 0.001 *
+                                              sampleRate));
+  lookaheadHasHistory = false;
+  setLookahead(lookaheadMs);
+
+  rmsRing.assign((size_t)std::ceil(maxRmsWindowMs * 0.001 * sampleRate) + 1,
+                 0.0);
+  rmsWindowSamples = 0;
+  setDetector(rmsMix, rmsWindowMs);
+
+  // Start from a real second-order high-pass even while the filter is off,
+  // so later in-place updates never change the filter order (which would
+  // reallocate the filter state)
+  keyFilterCoefficients =
+      juce::dsp::IIR::Coefficients<SampleType>::makeHighPass(
+          sampleRate, SampleType(60));
+  keyFilters.resize((size_t)juce::jmax(1, numChannels));
+  for (auto &filter : keyFilters) {
+    filter.coefficients = keyFilterCoefficients;
+    filter.prepare({sampleRate, (juce::uint32)maxBlockSize, 1});
+  }
+
+  auto frequency = keyFilterHz;
+  keyFilterHz = -1.0f;
+  setKeyFilter(frequency);
+}
+
+template <typename SampleType> void CompressorEngine<SampleType>::reset() {
+  envelope = 0;
+  slowEnvelope = 0;
+  std::fill(rmsRing.begin(), rmsRing.end(), 0.0);
+  rmsSum = 0.0;
+  rmsPosition = 0;
+  lookaheadBuffer.clear();
+  lookaheadWritePos = 0;
+  lookaheadHasHistory = false;
+  jumpToTargetLookahead();
+  for (auto &filter : keyFilters)
+    filter.reset();
+}
+
+template <typename SampleType>
+void CompressorEngine<SampleType>::setKeyFilter(float frequencyHz) {
+  frequencyHz = juce::jlimit(0.0f, (float)(sampleRate * 0.45), frequencyHz);
+  if (frequencyHz == keyFilterHz)
+    return;
+
+  keyFilterHz = frequencyHz;
+  if (keyFilterHz > 0.0f && keyFilterCoefficients != nullptr)
+    *keyFilterCoefficients =
+        juce::dsp::IIR::ArrayCoefficients<SampleType>::makeHighPass(
+            sampleRate, (SampleType)keyFilterHz);
+}
+
+template <typename SampleType>
+void CompressorEngine<SampleType>::setDetector(float newRmsMix,
+                                               float newRmsWindowMs) {
+  rmsMix = juce::jlimit(0.0f, 1.0f, newRmsMix);
+  rmsWindowMs = newRmsWindowMs;
+
+  auto newSamples =
+      juce::jlimit(1, juce::jmax(1, (int)rmsRing.size()),
+                   juce::roundToInt(rmsWindowMs * 0.001 * sampleRate));
+  if (newSamples == rmsWindowSamples)
+    return;
+
+  // Start the new window from silence; it fills within one window length
+  rmsWindowSamples = newSamples;
+  std::fill(rmsRing.begin(), rmsRing.end(), 0.0);
+  rmsSum = 0.0;
+  rmsPosition = 0;
+}
+
+template <typename SampleType>
+void CompressorEngine<SampleType>::setProgramRelease(bool shouldBeOn) {
+  if (shouldBeOn == programRelease)
+    return;
+
+  programRelease = shouldBeOn;
+  slowEnvelope = 0;
+  coeffAttackMs = coeffReleaseMs = -1.0f;
 }
 
-void CompressorEngine::process(juce::AudioBuffer<float> &buffer,
-                               float threshold, float ratio, float attackMs,
-                               float releaseMs) {
+template <typename SampleType>
+void CompressorEngine<SampleType>::setLookahead(float newLookaheadMs) {
+  lookaheadMs = newLookaheadMs;
+  targetLookaheadSamples =
+      juce::jlimit(0, maxLookaheadSamples,
+                   juce::roundToInt(lookaheadMs * 0.001 * sampleRate));
+
+  // Nothing processed since prepare() or reset(): no history to fade from,
+  // start from silence. Otherwise the next process() call crossfades to the
+  // new delay (updateLookahead).
+  if (!lookaheadHasHistory) {
+    lookaheadBuffer.clear();
+    lookaheadWritePos = 0;
+    jumpToTargetLookahead();
+  }
+}
+
+template <typename SampleType>
+void CompressorEngine<SampleType>::jumpToTargetLookahead() {
+  lookaheadSamples = targetLookaheadSamples;
+  fadeSamplesRemaining = 0;
+  peakWindow.reset();
+  peakWindow.setWindowLength(lookaheadSamples + 1);
+}
+
+template <typename SampleType>
+void CompressorEngine<SampleType>::updateLookahead() {
+  // Changes during a fade wait for it to finish, so a dragged knob moves
+  // the tap in a series of short fades rather than jumps
+  if (fadeSamplesRemaining > 0 || targetLookaheadSamples == lookaheadSamples)
+    return;
+
+  // The peak window wasn't fed while the lookahead was off
+  if (lookaheadSamples == 0)
+    peakWindow.reset();
+
+  fadeFromSamples = lookaheadSamples;
+  lookaheadSamples = targetLookaheadSamples;
+  fadeSamplesRemaining = fadeLength;
+  peakWindow.setWindowLength(lookaheadSamples + 1);
+}
+
+template <typename SampleType>
+void CompressorEngine<SampleType>::process(
+    juce::AudioBuffer<SampleType> &buffer, float threshold, float ratio,
+    float attackMs, float releaseMs, juce::AudioBuffer<SampleType> *key) {
+  processChunks(buffer, threshold, ratio, nullptr, attackMs, releaseMs, key);
+}
+
+template <typename SampleType>
+void CompressorEngine<SampleType>::process(
+    juce::AudioBuffer<SampleType> &buffer, float threshold,
+    const float *ratios, float attackMs, float releaseMs,
+    juce::AudioBuffer<SampleType> *key) {
+  processChunks(buffer, threshold, 1.0f, ratios, attackMs, releaseMs, key);
+}
+
+template <typename SampleType>
+void CompressorEngine<SampleType>::skipSilence(int numSamples, float threshold,
+                                               float attackMs,
+                                               float releaseMs) {
+  blockGainReductionDB = 0.0f;
+  updateCoefficients(attackMs, releaseMs);
+  thresholdLog2.setTargetValue(
+      (SampleType)(threshold / FastMath::decibelsPerLog2));
+  thresholdLog2.skip(numSamples);
+
+  // With a zero input the follower is env *= releaseCoeff every sample.
+  // The lookahead ring, the RMS window and the peak window only hold zeros
+  // by now, so they can stay, and a new delay needs no fade.
+  if (lookaheadSamples != targetLookaheadSamples || fadeSamplesRemaining > 0)
+    jumpToTargetLookahead();
+  envelope *= std::pow(releaseCoeff, (SampleType)numSamples);
+  slowEnvelope *= std::pow(slowReleaseCoeff, (SampleType)numSamples);
+}
+
+template <typename SampleType>
+void CompressorEngine<SampleType>::processChunks(
+    juce::AudioBuffer<SampleType> &buffer, float threshold, float ratio,
+    const float *ratios, float attackMs, float releaseMs,
+    juce::AudioBuffer<SampleType> *key) {
   auto numChannels = buffer.getNumChannels();
   auto numSamples = buffer.getNumSamples();
+  blockGainReductionDB = 0.0f;
+
+  if (numChannels == 0 || numSamples == 0 || maxBlockSize == 0)
+    return;
 
   // Simple VCA modeling
   // Check parameters to avoid division by zero
   if (ratio < 1.0f)
     ratio = 1.0f;
 
-  float attackCoeff = std::exp(-1.0f / (attackMs * 0.001f * sampleRate));
-  float releaseCoeff = std::exp(-1.0f / (releaseMs * 0.001f * sampleRate));
+  beginProcess(threshold, attackMs, releaseMs, key != nullptr);
 
-  for (int i = 0; i < numSamples; ++i) {
-    // 1. Detect Max/RMS Level
-    float inLevel = 0.0f;
-    for (int ch = 0; ch < numChannels; ++ch) {
-      inLevel = std::max(inLevel, std::abs(buffer.getSample(ch, i)));
+  juce::dsp::AudioBlock<SampleType> fullBlock(buffer);
+
+  // The key is read straight from the caller's (host's) buffer
+  juce::dsp::AudioBlock<SampleType> keyBlock;
+  if (key != nullptr) {
+    jassert(key->getNumSamples() >= numSamples);
+    keyBlock = juce::dsp::AudioBlock<SampleType>(*key);
+  }
+
+  for (int start = 0; start < numSamples; start += maxBlockSize) {
+    auto chunk = juce::jmin(maxBlockSize, numSamples - start);
+    auto block = fullBlock.getSubBlock((size_t)start, (size_t)chunk);
+
+    detectLevel(key != nullptr
+                    ? keyBlock.getSubBlock((size_t)start, (size_t)chunk)
+                    : block);
+    if (lookaheadSamples > 0)
+      peakWindow.process(detectorBuffer.data(), chunk);
+    followEnvelope(chunk);
+    computeGain(chunk, ratio, ratios != nullptr ? ratios + start : nullptr);
+    delayAudio(block);
+    applyGain(block);
+  }
+}
+
+template <typename SampleType>
+void CompressorEngine<SampleType>::beginProcess(float threshold,
+                                                float attackMs,
+                                                float releaseMs,
+                                                bool hasExternalKey) {
+  updateCoefficients(attackMs, releaseMs);
+
+  // Threshold moves are ramped per sample (in log2 units, see computeGain)
+  // so automation doesn't zipper
+  thresholdLog2.setTargetValue(
+      (SampleType)(threshold / FastMath::decibelsPerLog2));
+
+  updateLookahead();
+
+  // Filter history belongs to whichever signal was feeding it
+  if (hasExternalKey != keyIsExternal) {
+    keyIsExternal = hasExternalKey;
+    for (auto &filter : keyFilters)
+      filter.reset();
+  }
+}
+
+template <typename SampleType>
+template <size_t numLanes>
+void CompressorEngine<SampleType>::processLanes(
+    const std::array<CompressorEngine *, numLanes> &engines,
+    const std::array<juce::AudioBuffer<SampleType> *, numLanes> &buffers,
+    const std::array<float, numLanes> &thresholds,
+    const std::array<float, numLanes> &ratios, float attackMs,
+    float releaseMs,
+    const std::array<juce::AudioBuffer<SampleType> *, numLanes> &keys) {
+  auto numSamples = buffers[0]->getNumSamples();
+  auto maxChunk = engines[0]->maxBlockSize;
+
+  SampleType slope[numLanes];
+  for (size_t k = 0; k < numLanes; ++k) {
+    jassert(buffers[k]->getNumSamples() == numSamples);
+    jassert(engines[k]->maxBlockSize == maxChunk);
+    jassert(keys[k] == nullptr || keys[k]->getNumSamples() >= numSamples);
+    engines[k]->blockGainReductionDB = 0.0f;
+    engines[k]->beginProcess(thresholds[k], attackMs, releaseMs,
+                             keys[k] != nullptr);
+    slope[k] = SampleType(1) -
+               SampleType(1) / (SampleType)juce::jmax(1.0f, ratios[k]);
+  }
+
+  if (numSamples == 0 || maxChunk == 0)
+    return;
+
+  const auto maxReduction = (SampleType)FastMath::maxReductionLog2;
+
+  for (int start = 0; start < numSamples; start += maxChunk) {
+    auto chunk = juce::jmin(maxChunk, numSamples - start);
+
+    // 1. Detection, per lane (vectorized over samples and channels)
+    for (size_t k = 0; k < numLanes; ++k) {
+      auto &engine = *engines[k];
+      engine.detectLevel(
+          juce::dsp::AudioBlock<SampleType>(keys[k] != nullptr ? *keys[k]
+                                                               : *buffers[k])
+              .getSubBlock((size_t)start, (size_t)chunk));
+      if (engine.lookaheadSamples > 0)
+        engine.peakWindow.process(engine.detectorBuffer.data(), chunk);
+    }
+
+    // 2. Envelope followers, one lane each. Every lane is a serial
+    // recurrence; side by side they no longer wait on each other.
+    // Same follower as followEnvelope(), including the slow stage.
+    SampleType *level[numLanes], env[numLanes], slow[numLanes];
+    SampleType attack[numLanes], release[numLanes];
+    SampleType slowAttack[numLanes], slowRelease[numLanes];
+    for (size_t k = 0; k < numLanes; ++k) {
+      auto &engine = *engines[k];
+      level[k] = engine.detectorBuffer.data();
+      env[k] = engine.envelope;
+      slow[k] = engine.slowEnvelope;
+      attack[k] = engine.attackCoeff;
+      release[k] = engine.releaseCoeff;
+      slowAttack[k] = engine.slowAttackCoeff;
+      slowRelease[k] = engine.slowReleaseCoeff;
+    }
+
+    for (int i = 0; i < chunk; ++i)
+      for (size_t k = 0; k < numLanes; ++k) {
+        auto inLevel = level[k][i];
+        auto coeff = inLevel > env[k] ? attack[k] : release[k];
+        env[k] = coeff * env[k] + (SampleType(1) - coeff) * inLevel;
+        auto slowCoeff = inLevel > slow[k] ? slowAttack[k] : slowRelease[k];
+        slow[k] = slowCoeff * slow[k] + (SampleType(1) - slowCoeff) * inLevel;
+        level[k][i] = std::max(env[k], slow[k]);
+      }
+
+    // 3. Gain computers in one pass over all lanes (see computeGain)
+    const SampleType *threshold[numLanes];
+    SampleType *gain[numLanes];
+    for (size_t k = 0; k < numLanes; ++k) {
+      engines[k]->envelope = env[k];
+      engines[k]->slowEnvelope = slow[k];
+      threshold[k] = engines[k]->thresholdLog2.getNextBlockValues(chunk);
+      gain[k] = engines[k]->gainBuffer.data();
+    }
+
+    for (int i = 0; i < chunk; ++i)
+      for (size_t k = 0; k < numLanes; ++k) {
+        auto levelLog2 = FastMath::log2(level[k][i]);
+        gain[k][i] = std::min(
+            std::max(SampleType(0), levelLog2 - threshold[k][i]) * slope[k],
+            maxReduction);
+      }
+
+    for (size_t k = 0; k < numLanes; ++k)
+      engines[k]->blockGainReductionDB = std::max(
+          engines[k]->blockGainReductionDB,
+          (float)juce::FloatVectorOperations::findMaximum(gain[k], chunk) *
+              FastMath::decibelsPerLog2);
+
+    for (int i = 0; i < chunk; ++i)
+      for (size_t k = 0; k < numLanes; ++k)
+        gain[k][i] = FastMath::exp2(-gain[k][i]);
+
+    // 4. Delay and gain, per lane
+    for (size_t k = 0; k < numLanes; ++k) {
+      auto block = juce::dsp::AudioBlock<SampleType>(*buffers[k])
+                       .getSubBlock((size_t)start, (size_t)chunk);
+      engines[k]->delayAudio(block);
+      engines[k]->applyGain(block);
     }
+  }
+}
 
-    // 2. Envelope Follower
-    if (inLevel > envelope)
-      envelope = attackCoeff * envelope + (1.0f - attackCoeff) * inLevel;
-    else
-      envelope = releaseCoeff * envelope + (1.0f - releaseCoeff) * inLevel;
+template <typename SampleType>
+void CompressorEngine<SampleType>::detectLevel(
+    const juce::dsp::AudioBlock<SampleType> &block) {
+  auto numChannels = block.getNumChannels();
+  auto numSamples = (int)block.getNumSamples();
+  auto *level = detectorBuffer.data();
 
-    // 3. Gain Calculation
-    float envelopedB = juce::Decibels::gainToDecibels(envelope);
-    float gainReductiondB = 0.0f;
+  juce::FloatVectorOperations::clear(level, numSamples);
 
-    if (envelopedB > threshold) {
-      gainReductiondB = (envelopedB - threshold) * (1.0f - 1.0f / ratio);
+  if (keyFilterHz > 0.0f) {
+    // The filter is serial anyway, so filter and rectify in one go. The
+    // audio itself is never touched.
+    auto numFiltered = juce::jmin(numChannels, keyFilters.size());
+    for (size_t ch = 0; ch < numFiltered; ++ch) {
+      const auto *in = block.getChannelPointer(ch);
+      auto &filter = keyFilters[ch];
+      for (int i = 0; i < numSamples; ++i)
+        level[i] = std::max(level[i], std::abs(filter.processSample(in[i])));
+      filter.snapToZero();
     }
+  } else {
+    // Linked detector over every channel, in passes of up to four channels
+    // so the level is read and written once per group rather than per
+    // channel
+    size_t ch = 0;
+    for (; ch + 4 <= numChannels; ch += 4)
+      maxAbsInto<4>(level, block, ch);
+    for (; ch + 2 <= numChannels; ch += 2)
+      maxAbsInto<2>(level, block, ch);
+    for (; ch < numChannels; ++ch)
+      maxAbsInto<1>(level, block, ch);
+  }
+
+  if (rmsMix > 0.0f)
+    blendRms(numSamples);
+}
+
+template <typename SampleType>
+void CompressorEngine<SampleType>::blendRms(int numSamples) {
+  auto *level = detectorBuffer.data();
+  auto *ring = rmsRing.data();
+  const auto mix = (SampleType)rmsMix;
+  const auto scale = 1.0 / rmsWindowSamples;
+  auto sum = rmsSum;
+
+  // In runs up to the end of the ring, so the wrap isn't checked per sample
+  for (int start = 0; start < numSamples;) {
+    auto run = juce::jmin(numSamples - start, rmsWindowSamples - rmsPosition);
+    auto *peak = level + start;
+    auto *square = ring + rmsPosition;
 
-    lastGainReductionDB.store(gainReductiondB);
+    for (int i = 0; i < run; ++i) {
+      auto x = (double)peak[i] * (double)peak[i];
+      sum += x - square[i];
+      square[i] = x;
+      auto rms = (SampleType)std::sqrt(std::max(0.0, sum * scale));
+      peak[i] += mix * (rms - peak[i]);
+    }
 
-    float gain = juce::Decibels::decibelsToGain(-gainReductiondB);
+    start += run;
+    rmsPosition += run;
 
-    // 4. Apply Gain
-    for (int ch = 0; ch < numChannels; ++ch) {
-      float currentSample = buffer.getSample(ch, i);
-      buffer.setSample(ch, i, currentSample * gain);
+    // Once per lap, replace the running sum with the exact one so rounding
+    // can't accumulate. Still O(1) per sample on average.
+    if (rmsPosition == rmsWindowSamples) {
+      rmsPosition = 0;
+      sum = std::accumulate(ring, ring + rmsWindowSamples, 0.0);
     }
   }
+
+  rmsSum = sum;
+}
+
+template <typename SampleType>
+void CompressorEngine<SampleType>::updateCoefficients(float attackMs,
+                                                      float releaseMs) {
+  // Two std::exp per change rather than per block
+  if (attackMs == coeffAttackMs && releaseMs == coeffReleaseMs)
+    return;
+
+  coeffAttackMs = attackMs;
+  coeffReleaseMs = releaseMs;
+  attackCoeff = (SampleType)std::exp(-1.0 / (attackMs * 0.001 * sampleRate));
+  releaseCoeff =
+      (SampleType)std::exp(-1.0 / (releaseMs * 0.001 * sampleRate));
+
+  // The slow stage charges over the release time, so only material that
+  // lasts about that long engages it, and lets go slowReleaseFactor times
+  // slower
+  if (programRelease) {
+    slowAttackCoeff =
+        (SampleType)std::exp(-1.0 / (releaseMs * 0.001 * sampleRate));
+    slowReleaseCoeff = (SampleType)std::exp(
+        -1.0 / (releaseMs * slowReleaseFactor * 0.001 * sampleRate));
+  } else {
+    slowAttackCoeff = slowReleaseCoeff = SampleType(1);
+  }
 }
+
+template <typename SampleType>
+void CompressorEngine<SampleType>::followEnvelope(int numSamples) {
+  auto *level = detectorBuffer.data();
+  auto env = envelope, slow = slowEnvelope;
+
+  // The selects compile to conditional moves, not branches. The slow stage
+  // is a second, independent recurrence, so it runs alongside the first.
+  for (int i = 0; i < numSamples; ++i) {
+    auto inLevel = level[i];
+    auto coeff = inLevel > env ? attackCoeff : releaseCoeff;
+    env = coeff * env + (SampleType(1) - coeff) * inLevel;
+    auto slowCoeff = inLevel > slow ? slowAttackCoeff : slowReleaseCoeff;
+    slow = slowCoeff * slow + (SampleType(1) - slowCoeff) * inLevel;
+    level[i] = std::max(env, slow);
+  }
+
+  envelope = env;
+  slowEnvelope = slow;
+}
+
+template <typename SampleType>
+void CompressorEngine<SampleType>::computeGain(int numSamples, float ratio,
+                                               const float *ratios) {
+  const auto *env = detectorBuffer.data();
+  auto *gain = gainBuffer.data();
+  // A per-sample ratio is applied in a second pass below
+  const auto slope = ratios != nullptr
+                         ? SampleType(1)
+                         : SampleType(1) - SampleType(1) / (SampleType)ratio;
+
+  // Work in log2 units rather than dB so each sample costs one log2 and one
+  // exp2 (see FastMath.h for the error bounds of the fast kernels)
+  const auto maxReduction = (SampleType)FastMath::maxReductionLog2;
+
+  // Gain reduction, against a per-sample threshold only while it ramps
+  if (const auto *thresholdRamp = thresholdLog2.getNextBlock(numSamples)) {
+    for (int i = 0; i < numSamples; ++i) {
+      auto levelLog2 = FastMath::log2(env[i]);
+      gain[i] = std::min(
+          std::max(SampleType(0), levelLog2 - thresholdRamp[i]) * slope,
+          maxReduction);
+    }
+  } else {
+    const auto threshold = thresholdLog2.getCurrentValue();
+    for (int i = 0; i < numSamples; ++i) {
+      auto levelLog2 = FastMath::log2(env[i]);
+      gain[i] = std::min(
+          std::max(SampleType(0), levelLog2 - threshold) * slope,
+          maxReduction);
+    }
+  }
+
+  if (ratios != nullptr) {
+    for (int i = 0; i < numSamples; ++i)
+      gain[i] = std::min(
+          gain[i] * (SampleType(1) - SampleType(1) / (SampleType)ratios[i]),
+          maxReduction);
+  }
+
+  blockGainReductionDB = std::max(
+      blockGainReductionDB,
+      (float)juce::FloatVectorOperations::findMaximum(gain, numSamples) *
+          FastMath::decibelsPerLog2);
+
+  // Back to linear gain
+  for (int i = 0; i < numSamples; ++i)
+    gain[i] = FastMath::exp2(-gain[i]);
+}
+
+template <typename SampleType>
+void CompressorEngine<SampleType>::applyGain(
+    juce::dsp::AudioBlock<SampleType> &block) {
+  auto numChannels = block.getNumChannels();
+  const auto *gain = gainBuffer.data();
+
+  // Same grouping as the detector: one gain load feeds up to four channels
+  size_t ch = 0;
+  for (; ch + 4 <= numChannels; ch += 4)
+    multiplyInto<4>(block, ch, gain);
+  for (; ch + 2 <= numChannels; ch += 2)
+    multiplyInto<2>(block, ch, gain);
+  for (; ch < numChannels; ++ch)
+    multiplyInto<1>(block, ch, gain);
+}
+
+template <typename SampleType>
+void CompressorEngine<SampleType>::delayAudio(
+    juce::dsp::AudioBlock<SampleType> &block) {
+  auto numSamples = (int)block.getNumSamples();
+  auto numChannels = juce::jmin((int)block.getNumChannels(),
+                                lookaheadBuffer.getNumChannels());
+  auto ringSize = lookaheadBuffer.getNumSamples();
+
+  auto readPos = lookaheadWritePos - lookaheadSamples;
+  if (readPos < 0)
+    readPos += ringSize;
+  auto fadeFromPos = lookaheadWritePos - fadeFromSamples;
+  if (fadeFromPos < 0)
+    fadeFromPos += ringSize;
+
+  auto fade = juce::jmin(numSamples, fadeSamplesRemaining);
+  auto fadeStep = SampleType(1) / (SampleType)fadeLength;
+  auto fadeStart = (SampleType)(fadeLength - fadeSamplesRemaining);
+
+  // Append the new input, then read back lookaheadSamples earlier. The ring
+  // holds maxLookahead + maxBlockSize samples, so the write never overlaps
+  // the history still to be read. The input is written even without
+  // lookahead, so a later delay change has history to fade to.
+  for (int ch = 0; ch < numChannels; ++ch) {
+    auto *ring = lookaheadBuffer.getWritePointer(ch);
+    auto *data = block.getChannelPointer((size_t)ch);
+    writeToRing(ring, ringSize, lookaheadWritePos, data, numSamples);
+
+    // Crossfade from the old delay to the new one after a change
+    for (int i = 0; i < fade; ++i) {
+      auto from = ring[(fadeFromPos + i) % ringSize];
+      auto to = ring[(readPos + i) % ringSize];
+      auto w = (fadeStart + (SampleType)(i + 1)) * fadeStep;
+      data[i] = from + w * (to - from);
+    }
+
+    if (lookaheadSamples > 0)
+      readFromRing(ring, ringSize, (readPos + fade) % ringSize, data + fade,
+                   numSamples - fade);
+  }
+
+  fadeSamplesRemaining -= fade;
+  lookaheadWritePos = (lookaheadWritePos + numSamples) % ringSize;
+  lookaheadHasHistory = true;
+}
+
+template class CompressorEngine<float>;
+template class CompressorEngine<double>;
+
+template void CompressorEngine<float>::processLanes<3>(
+    const std::array<CompressorEngine<float> *, 3> &,
+    const std::array<juce::AudioBuffer<float> *, 3> &,
+    const std::array<float, 3> &, const std::array<float, 3> &, float, float,
+    const std::array<juce::AudioBuffer<float> *, 3> &);
+template void CompressorEngine<double>::processLanes<3>(
+    const std::array<CompressorEngine<double> *, 3> &,
+    const std::array<juce::AudioBuffer<double> *, 3> &,
+    const std::array<float, 3> &, const std::array<float, 3> &, float, float,
+    const std::array<juce::AudioBuffer<double> *, 3> &);
@@ -1,16 +1,178 @@
 #pragma once
+#include "FastMath.h"
+#include "SlidingWindowMax.h"
+#include "SmoothedParameter.h"
 #include <JuceHeader.h>
 
-class CompressorEngine {
+// Feed-forward VCA compressor.
+//
+// The block is processed in passes over planar channel data so the heavy
+// loops vectorize: a max-abs detector, the (inherently serial) envelope
+// follower, the gain computer and finally the gain multiply.
+//
+// The detector is a peak detector, an RMS detector over a sliding window
+// (a running sum over a ring of squares, so constant cost per sample at any
+// window length) or a blend of the two. The follower can add a second, slow
+// release stage: short transients release at the set time, sustained
+// material holds for longer (program-dependent release).
+//
+// With lookahead enabled the audio is delayed and the detector takes the
+// max over the lookahead window, so gain reduction is in place before a
+// peak reaches the output.
+//
+// The detector normally listens to the input itself. Passing a key buffer
+// (e.g. the sidechain bus) makes it listen to that instead; the key is read
+// in place and only ever filtered on the way into the detector.
+//
+// Templated on the sample type so 64-bit hosts run natively; the envelope
+// follower and filters then keep double precision throughout. Instantiated
+// for float and double in CompressorEngine.cpp.
+template <typename SampleType> class CompressorEngine {
 public:
+  static constexpr float maxLookaheadMs = 10.0f;
+  static constexpr float maxRmsWindowMs = 50.0f;
+  static constexpr float lookaheadFadeMs = 5.0f;
+
+  // The slow release stage releases this much slower than the set release
+  static constexpr float slowReleaseFactor = 5.0f;
+
   CompressorEngine();
-  void prepare(double sampleRate, int samplesPerBlock);
-  void process(juce::AudioBuffer<float> &buffer, float threshold, float ratio,
-               float attackMs, float releaseMs);
-  float getGainReductionDB() const { return lastGainReductionDB.load(); }
+  void prepare(double sampleRate, int samplesPerBlock, int numChannels);
+
+  // Clears the envelope, lookahead delay and detector filters
+  void reset();
+
+  // 0 to maxLookaheadMs. Adds the same amount of latency. A change while
+  // running crossfades to the new delay over lookaheadFadeMs.
+  void setLookahead(float lookaheadMs);
+  int getLatencySamples() const { return targetLookaheadSamples; }
+
+  // key, if given, must be at least as long as buffer. It is not modified.
+  void process(juce::AudioBuffer<SampleType> &buffer, float threshold,
+               float ratio, float attackMs, float releaseMs,
+               juce::AudioBuffer<SampleType> *key = nullptr);
+
+  // Same with one ratio per sample (>= 1), e.g. from CoreProtect
+  void process(juce::AudioBuffer<SampleType> &buffer, float threshold,
+               const float *ratios, float attackMs, float releaseMs,
+               juce::AudioBuffer<SampleType> *key = nullptr);
+
+  // Runs several engines, each on its own buffer with its own threshold and
+  // ratio, in lock-step (e.g. the bands of MultibandCompressor). The serial
+  // envelope followers run as independent lanes of one loop, and the gain
+  // computers share one pass, instead of one engine after the other.
+  // Buffers must have the same length; engines must share a block size.
+  // A lane's key, if given, works as in process(). Instantiated for 3 lanes.
+  template <size_t numLanes>
+  static void processLanes(
+      const std::array<CompressorEngine *, numLanes> &engines,
+      const std::array<juce::AudioBuffer<SampleType> *, numLanes> &buffers,
+      const std::array<float, numLanes> &thresholds,
+      const std::array<float, numLanes> &ratios, float attackMs,
+      float releaseMs,
+      const std::array<juce::AudioBuffer<SampleType> *, numLanes> &keys = {});
+
+  // 0 = peak, 1 = RMS over rmsWindowMs (up to maxRmsWindowMs), in between
+  // blends the two. Doesn't allocate.
+  void setDetector(float rmsMix, float rmsWindowMs);
+
+  // Adds the slow release stage
+  void setProgramRelease(bool shouldBeOn);
+
+  // High-pass on the detector path only, so low end in the key doesn't
+  // pump the compressor. 0 turns it off. Doesn't allocate.
+  void setKeyFilter(float frequencyHz);
+
+  // Stands in for process() on a silent buffer once the lookahead has
+  // drained: the envelope is decayed analytically and the audio is left
+  // alone
+  void skipSilence(int numSamples, float threshold, float attackMs,
+                   float releaseMs);
+
+  // Largest gain reduction applied during the last process() call. Audio
+  // thread only; the processor publishes it through the meter FIFO.
+  float getBlockGainReductionDB() const { return blockGainReductionDB; }
 
 private:
-  std::atomic<float> lastGainReductionDB{0.0f};
+  // ratios is null for a fixed ratio
+  void processChunks(juce::AudioBuffer<SampleType> &buffer, float threshold,
+                     float ratio, const float *ratios, float attackMs,
+                     float releaseMs, juce::AudioBuffer<SampleType> *key);
+
+  // 1. Linked peak detector: max |x| across the key's channels (optionally
+  // high-passed) into detectorBuffer
+  void detectLevel(const juce::dsp::AudioBlock<SampleType> &block);
+  // Sets up a process() call: coefficients, threshold target and the key
+  // filter state for an internal or external key
+  void beginProcess(float threshold, float attackMs, float releaseMs,
+                    bool hasExternalKey);
+  // 1b. RMS over the window and the peak/RMS blend, in place on
+  // detectorBuffer
+  void blendRms(int numSamples);
+  // 2. Envelope follower, runs in place on detectorBuffer
+  void followEnvelope(int numSamples);
+  // 3. Gain computer: envelope -> linear gain into gainBuffer
+  void computeGain(int numSamples, float ratio, const float *ratios);
+  // 4. Multiply every channel by gainBuffer
+  void applyGain(juce::dsp::AudioBlock<SampleType> &block);
+  // Delays the audio by lookaheadSamples through lookaheadBuffer
+  void delayAudio(juce::dsp::AudioBlock<SampleType> &block);
+  // Starts the crossfade to a new lookahead set by setLookahead()
+  void updateLookahead();
+  // Switches to the new lookahead at once, without a fade
+  void jumpToTargetLookahead();
+
+  float blockGainReductionDB = 0.0f;
   double sampleRate = 44100.0;
-  float envelope = 0.0f;
+  SampleType envelope = 0;
+
+  // Attack/release coefficients, recomputed only when a time or the sample
+  // rate changes
+  void updateCoefficients(float attackMs, float releaseMs);
+  SampleType attackCoeff = 0, releaseCoeff = 0;
+
+  // Slow release stage. With program release off both coefficients are 1
+  // and slowEnvelope stays 0, so the follower needs no mode branch.
+  SampleType slowEnvelope = 0;
+  SampleType slowAttackCoeff = 1, slowReleaseCoeff = 1;
+  bool programRelease = false;
+  float coeffAttackMs = -1.0f, coeffReleaseMs = -1.0f;
+
+  // Threshold in log2 units, ramped to avoid zipper noise
+  SmoothedParameter<SampleType> thresholdLog2;
+
+  // RMS detector: squares of the last rmsWindowSamples detector values and
+  // their running sum, kept in double so the sum doesn't drift
+  std::vector<double> rmsRing;
+  double rmsSum = 0.0;
+  int rmsWindowSamples = 1, rmsPosition = 0;
+  float rmsMix = 0.0f, rmsWindowMs = 10.0f;
+
+  // Detector high-pass: one state per key channel sharing coefficients
+  // that are rewritten in place when the frequency changes
+  std::vector<juce::dsp::IIR::Filter<SampleType>> keyFilters;
+  typename juce::dsp::IIR::Coefficients<SampleType>::Ptr keyFilterCoefficients;
+  float keyFilterHz = 0.0f;
+  bool keyIsExternal = false;
+
+  // Per-block work buffers, sized in prepare(). Longer host blocks are
+  // processed in chunks of maxBlockSize.
+  std::vector<SampleType> detectorBuffer, gainBuffer;
+  int maxBlockSize = 0;
+
+  // Lookahead: audio delay ring (maxLookahead + maxBlockSize long) and the
+  // detector's sliding-window max, both preallocated in prepare()
+  SlidingWindowMax<SampleType> peakWindow;
+  juce::AudioBuffer<SampleType> lookaheadBuffer;
+  float lookaheadMs = 0.0f;
+  int maxLookaheadSamples = 0;
+  int lookaheadSamples = 0;
+  int lookaheadWritePos = 0;
+
+  // Lookahead changes: the delay asked for, and the fade from the old tap
+  int targetLookaheadSamples = 0;
+  int fadeFromSamples = 0;
+  int fadeSamplesRemaining = 0;
+  int fadeLength = 1;
+  bool lookaheadHasHistory = false; // set by delayAudio()
 };
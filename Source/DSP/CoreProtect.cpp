@@ -1,38 +1,136 @@
 #include "CoreProtect.h"
 
-CoreProtect::CoreProtect() {}
+template <typename SampleType> CoreProtect<SampleType>::CoreProtect() {}
 
-void CoreProtect::prepare(double sr, int samplesPerBlock) {
+template <typename SampleType>
+void CoreProtect<SampleType>::prepare(double sr, int samplesPerBlock,
+                                      int numChannels) {
   sampleRate = sr;
-  // 300Hz - 3kHz Bandpass
-  auto coefficients = juce::dsp::IIR::Coefficients<float>::makeBandPass(
-      sampleRate, 1000.0f, 1.5f); // Center 1kHz, Q 1.5 approx cover 300-3k
-  bandpassFilter.coefficients = coefficients;
-  bandpassFilter.reset();
-  envelope = 0.0f;
+  numChannels = juce::jmax(1, numChannels);
+  samplesPerBlock = juce::jmax(1, samplesPerBlock);
+
+  // 300Hz - 3kHz Bandpass: center 1kHz, Q 1.5 approx cover 300-3k
+  bandpass.prepare(numChannels, samplesPerBlock);
+  bandpass.setCoefficients(Filter::Coefficients::makeBandPass(
+      sampleRate, SampleType(1000), SampleType(1.5)));
+  preparedChannels = numChannels;
+
+  // One-pole smoothing of the squared band signal
+  attackCoeff =
+      (SampleType)(1.0 - std::exp(-1.0 / (attackMs * 0.001 * sampleRate)));
+  releaseCoeff =
+      (SampleType)(1.0 - std::exp(-1.0 / (releaseMs * 0.001 * sampleRate)));
+  meanSquare.assign((size_t)bandpass.getNumGroups(), {});
+
+  ratioBuffer.assign((size_t)samplesPerBlock, 1.0f);
+  reset();
 }
 
-float CoreProtect::process(const juce::AudioBuffer<float> &buffer,
-                           float originalRatio) {
-  // Analyze the block to detect energy in the "Core" band (300Hz-3kHz)
-  // We create a copy to filter without affecting the original audio
-  juce::AudioBuffer<float> tempBuffer;
-  tempBuffer.makeCopyOf(buffer);
-
-  juce::dsp::AudioBlock<float> block(tempBuffer);
-  juce::dsp::ProcessContextReplacing<float> context(block);
-  bandpassFilter.process(context);
-
-  // Calculate RMS of the bandpassed signal
-  float rms = tempBuffer.getRMSLevel(0, 0, tempBuffer.getNumSamples());
-  if (tempBuffer.getNumChannels() > 1) {
-    rms =
-        std::max(rms, tempBuffer.getRMSLevel(1, 0, tempBuffer.getNumSamples()));
+template <typename SampleType> void CoreProtect<SampleType>::reset() {
+  bandpass.reset();
+  std::fill(meanSquare.begin(), meanSquare.end(), typename Filter::Lanes{});
+  samplesUntilUpdate = 0;
+  ratioStep = 0.0f;
+  primed = false;
+}
+
+template <typename SampleType>
+const float *
+CoreProtect<SampleType>::process(const juce::AudioBuffer<SampleType> &buffer,
+                                 float originalRatio) {
+  // Analyze the block to detect energy in the "Core" band (300Hz-3kHz).
+  // The original audio is only read.
+  auto numInputs = juce::jmin(buffer.getNumChannels(), preparedChannels);
+  const auto *const *channels = buffer.getArrayOfReadPointers();
+  jassert(buffer.getNumSamples() <= (int)ratioBuffer.size());
+  auto numSamples = juce::jmin(buffer.getNumSamples(), (int)ratioBuffer.size());
+  const auto coefficients = bandpass.getCoefficients();
+
+  for (int pos = 0; pos < numSamples;) {
+    // Run up to the next control update, which may fall in a later block
+    auto segment = juce::jmin(samplesUntilUpdate, numSamples - pos);
+
+    for (int group = 0; group < bandpass.getNumGroups(); ++group) {
+      const SampleType *in[Filter::numLanes];
+      bandpass.getGroupInputs(group, channels, numInputs, pos, in);
+      auto state = bandpass.getState(group);
+      auto ms = meanSquare[(size_t)group];
+
+      for (int i = 0; i < segment; ++i) {
+        typename Filter::Lanes x;
+        for (int l = 0; l < Filter::numLanes; ++l)
+          x[(size_t)l] = in[l][i];
+
+        auto band = Filter::processSample(coefficients, state, x);
+        for (int l = 0; l < Filter::numLanes; ++l) {
+          auto square = band[(size_t)l] * band[(size_t)l];
+          auto &m = ms[(size_t)l];
+          m += (square > m ? attackCoeff : releaseCoeff) * (square - m);
+        }
+      }
+
+      Filter::snapToZero(state);
+      bandpass.setState(group, state);
+      meanSquare[(size_t)group] = ms;
+    }
+
+    for (int i = 0; i < segment; ++i) {
+      currentRatio += ratioStep;
+      ratioBuffer[(size_t)(pos + i)] = currentRatio;
+    }
+
+    pos += segment;
+    samplesUntilUpdate -= segment;
+
+    if (samplesUntilUpdate == 0) {
+      auto newRatio = computeRatio(originalRatio);
+      if (!primed) {
+        // Start from the first value rather than ramping in from 1:1
+        targetRatio = newRatio;
+        primed = true;
+      }
+
+      // Land exactly on the previous target, then ramp to the new one
+      currentRatio = targetRatio;
+      targetRatio = newRatio;
+      ratioStep = (targetRatio - currentRatio) / (float)controlInterval;
+      samplesUntilUpdate = controlInterval;
+    }
   }
 
-  // Simple Envelope Follower for smooth modulation
-  float attack = 0.1f;   // fast attack
-  float release = 0.01f; // slow release
+  return ratioBuffer.data();
+}
+
+template <typename SampleType>
+void CoreProtect<SampleType>::skipSilence(int numSamples,
+                                          float originalRatio) {
+  bandpass.reset();
+
+  // A zero input always takes the release branch
+  auto decay = std::pow(SampleType(1) - releaseCoeff, (SampleType)numSamples);
+  for (auto &lanes : meanSquare)
+    for (auto &ms : lanes)
+      ms *= decay;
+
+  // Keep the control phase running and settle on the current value
+  samplesUntilUpdate -= numSamples % controlInterval;
+  if (samplesUntilUpdate <= 0)
+    samplesUntilUpdate += controlInterval;
+
+  currentRatio = targetRatio = computeRatio(originalRatio);
+  ratioStep = 0.0f;
+  primed = true;
+}
+
+template <typename SampleType>
+float CoreProtect<SampleType>::computeRatio(float originalRatio) const {
+  // RMS of the bandpassed signal (loudest channel; lanes without a channel
+  // only ever see silence)
+  auto maxMeanSquare = SampleType(0);
+  for (auto &lanes : meanSquare)
+    for (auto ms : lanes)
+      maxMeanSquare = std::max(maxMeanSquare, ms);
+  auto rms = (float)std::sqrt(maxMeanSquare);
 
   // Normalize RMS roughly (0.0 - 1.0)
   // If there is significant energy, reduce ratio
@@ -57,3 +155,6 @@ float CoreProtect::process(const juce::AudioBuffer<float> &buffer,
 
   return std::max(1.0f, effectiveRatio);
 }
+
+template class CoreProtect<float>;
+template class CoreProtect<double>;
@@ -1,16 +1,60 @@
 #pragma once
+#include "BiquadFilter.h"
 #include <JuceHeader.h>
 
-class CoreProtect {
+// Eases the ratio off when there's a lot of energy in the "Core" band
+// (300Hz-3kHz).
+//
+// The band energy is tracked sample by sample with a running mean-square
+// per channel and the ratio is updated at a fixed control rate, so the
+// result doesn't depend on the host block size. Instantiated for float and
+// double in CoreProtect.cpp.
+template <typename SampleType> class CoreProtect {
 public:
+  // Samples between ratio updates
+  static constexpr int controlInterval = 16;
+
   CoreProtect();
-  void prepare(double sampleRate, int samplesPerBlock);
+  void prepare(double sampleRate, int samplesPerBlock, int numChannels);
+  // Clears the band-pass and the followers
+  void reset();
+
+  // Returns the effective ratio for every sample of the buffer, ramping
+  // between control updates. Valid until the next call; the buffer must not
+  // be longer than samplesPerBlock.
+  const float *process(const juce::AudioBuffer<SampleType> &buffer,
+                       float originalRatio);
 
-  // Returns the modified ratio
-  float process(const juce::AudioBuffer<float> &buffer, float originalRatio);
+  // Stands in for process() on numSamples of silence once the band-pass
+  // has rung out: the followers decay analytically and the filters are
+  // cleared
+  void skipSilence(int numSamples, float originalRatio);
+
+  // Latest ratio control value, for metering
+  float getEffectiveRatio() const { return targetRatio; }
 
 private:
+  float computeRatio(float originalRatio) const;
+
   double sampleRate = 44100.0;
-  juce::dsp::IIR::Filter<float> bandpassFilter;
-  float envelope = 0.0f;
+
+  // Band-pass with a state per channel. Filtering runs sample by sample
+  // alongside the follower, a lane group of channels at a time, so no
+  // sidechain copy is needed.
+  using Filter = BiquadFilter<SampleType>;
+  Filter bandpass;
+  int preparedChannels = 0;
+
+  // Mean-square follower: fast attack, slow release
+  static constexpr float attackMs = 10.0f;
+  static constexpr float releaseMs = 100.0f;
+  SampleType attackCoeff = 0, releaseCoeff = 0;
+  std::vector<typename Filter::Lanes> meanSquare; // per lane group
+
+  // Ratio control: a linear ramp from currentRatio towards targetRatio
+  // over each control interval, expanded per sample into ratioBuffer
+  std::vector<float> ratioBuffer;
+  int samplesUntilUpdate = 0;
+  float currentRatio = 1.0f, targetRatio = 1.0f, ratioStep = 0.0f;
+  bool primed = false;
 };
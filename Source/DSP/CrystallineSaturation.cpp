@@ -1,56 +1,215 @@
 #include "CrystallineSaturation.h"
 
-CrystallineSaturation::CrystallineSaturation() {}
+template <typename SampleType>
+CrystallineSaturation<SampleType>::CrystallineSaturation() {}
 
-void CrystallineSaturation::prepare(double sr, int samplesPerBlock) {
+template <typename SampleType>
+void CrystallineSaturation<SampleType>::prepare(double sr, int samplesPerBlock,
+                                                int numChannels) {
   sampleRate = sr;
+  numChannels = juce::jmax(1, numChannels);
+  samplesPerBlock = juce::jmax(1, samplesPerBlock);
+
   // Highpass at 15kHz to isolate "Air" band
-  auto coefficients =
-      juce::dsp::IIR::Coefficients<float>::makeHighPass(sampleRate, 15000.0f);
-  highPassFilter.coefficients = coefficients;
-  highPassFilter.reset();
+  highPassFilter.prepare(numChannels, samplesPerBlock);
+  highPassFilter.setCoefficients(
+      BiquadFilter<SampleType>::Coefficients::makeHighPass(
+          sampleRate, SampleType(15000)));
+
+  highFreqBuffer.setSize(numChannels, samplesPerBlock);
+  highFreqBuffer.clear();
+
+  for (int i = 0; i < maxOversamplingIndex; ++i) {
+    oversamplers[i] = std::make_unique<juce::dsp::Oversampling<SampleType>>(
+        (size_t)numChannels, (size_t)(i + 1),
+        juce::dsp::Oversampling<SampleType>::filterHalfBandPolyphaseIIR, true,
+        true);
+    oversamplers[i]->initProcessing((size_t)samplesPerBlock);
+  }
+
+  dryDelay.prepare({sampleRate, (juce::uint32)samplesPerBlock,
+                    (juce::uint32)numChannels});
+
+  gainDB.prepare(sampleRate, samplesPerBlock);
+  gainRamp.assign((size_t)samplesPerBlock, SampleType(0));
+  mixRamp.assign((size_t)samplesPerBlock, SampleType(0));
+
+  switchFadeLength = juce::jmax(1, juce::roundToInt(sampleRate *
+                                                     switchFadeSeconds));
+
+  // Latencies depend on the new oversamplers, and nothing is playing yet
+  auto index = pendingIndex;
+  pendingIndex = -1;
+  setOversampling(index);
+  reset();
 }
 
-void CrystallineSaturation::process(juce::AudioBuffer<float> &buffer,
-                                    float inputGainDB) {
+template <typename SampleType>
+void CrystallineSaturation<SampleType>::setOversampling(int factorIndex) {
+  factorIndex = juce::jlimit(0, maxOversamplingIndex, factorIndex);
+  if (factorIndex == pendingIndex)
+    return;
+
+  pendingIndex = factorIndex;
+
+  if (pendingIndex > 0 && oversamplers[pendingIndex - 1])
+    latencySamples = juce::roundToInt(
+        oversamplers[pendingIndex - 1]->getLatencyInSamples());
+  else
+    latencySamples = 0;
+
+  // Nothing to fade while at rest; otherwise process() fades out first
+  if (filtersAtRest)
+    switchOversampling();
+}
+
+template <typename SampleType>
+void CrystallineSaturation<SampleType>::switchOversampling() {
+  oversamplingIndex = pendingIndex;
+  if (oversamplingIndex > 0 && oversamplers[oversamplingIndex - 1])
+    oversamplers[oversamplingIndex - 1]->reset();
+
+  dryDelaySamples = latencySamples;
+  dryDelay.reset();
+  dryDelay.setDelay((SampleType)dryDelaySamples);
+}
+
+template <typename SampleType>
+void CrystallineSaturation<SampleType>::process(
+    juce::AudioBuffer<SampleType> &buffer, float inputGainDB) {
   // Crystalline Saturation:
   // 1. High-shelf boost or high-frequency harmonic generation linked to Gain.
   // 2. Here we implement a parallel saturation path for >15kHz.
 
-  // Create a copy for high frequency extraction
-  juce::AudioBuffer<float> highFreqBuffer;
-  highFreqBuffer.makeCopyOf(buffer);
+  // Gain changes are ramped in dB to avoid zipper noise
+  gainDB.setTargetValue((SampleType)inputGainDB);
 
-  juce::dsp::AudioBlock<float> block(highFreqBuffer);
-  juce::dsp::ProcessContextReplacing<float> context(block);
-  highPassFilter.process(context);
+  auto numSamples = buffer.getNumSamples();
+  auto numChannels =
+      juce::jmin(buffer.getNumChannels(), highFreqBuffer.getNumChannels());
+  auto capacity = highFreqBuffer.getNumSamples();
 
-  float gainLinear = juce::Decibels::decibelsToGain(inputGainDB);
+  filtersAtRest = false;
 
-  // Apply saturation to the high frequencies
-  // Simple soft clipper or even harmonic generator
-  auto numSamples = highFreqBuffer.getNumSamples();
-  auto numChannels = highFreqBuffer.getNumChannels();
+  for (int start = 0, chunk = 0; start < numSamples; start += chunk) {
+    chunk = juce::jmin(capacity, numSamples - start);
 
-  for (int ch = 0; ch < numChannels; ++ch) {
-    auto *data = highFreqBuffer.getWritePointer(ch);
-    const auto *origData = buffer.getReadPointer(ch);
-    auto *outData = buffer.getWritePointer(ch);
+    // A factor change fades out over whole chunks, switches at silence and
+    // fades back in. Chunks end where the fade-out does.
+    auto switching = pendingIndex != oversamplingIndex;
+    if (switching && switchFadeLevel == 0) {
+      switchOversampling();
+      switching = false;
+    }
+    if (switching)
+      chunk = juce::jmin(chunk, switchFadeLevel);
+    auto fadeStep = switching ? -1 : switchFadeLevel < switchFadeLength ? 1 : 0;
 
-    for (int i = 0; i < numSamples; ++i) {
-      float x = data[i];
-      // Even harmonic generation: x + a * x^2
-      // We want to add "sparkle" so we rectify slightly
-      float saturated = x + 0.5f * x * x;
+    auto *oversampler =
+        oversamplingIndex > 0 ? oversamplers[oversamplingIndex - 1].get()
+                              : nullptr;
 
-      // Mix back into original signal
-      // The amount of saturation is proportional to the Gain parameter
-      // If Gain is high, we add more "Air"
-      float mixAmount =
-          0.1f * std::max(0.0f, inputGainDB / 24.0f); // Max 10% mix at max gain
+    // Copy into the preallocated scratch for high frequency extraction
+    for (int ch = 0; ch < numChannels; ++ch)
+      highFreqBuffer.copyFrom(ch, 0, buffer, ch, start, chunk);
 
+    highPassFilter.process(highFreqBuffer.getArrayOfWritePointers(),
+                           numChannels, chunk);
+    auto block = juce::dsp::AudioBlock<SampleType>(highFreqBuffer)
+                     .getSubsetChannelBlock(0, (size_t)numChannels)
+                     .getSubBlock(0, (size_t)chunk);
+
+    // Apply saturation to the high frequencies
+    // Simple soft clipper or even harmonic generator
+    // Even harmonic generation: x + a * x^2
+    // We want to add "sparkle" so we rectify slightly
+    auto saturate = [](juce::dsp::AudioBlock<SampleType> &hf) {
+      for (size_t ch = 0; ch < hf.getNumChannels(); ++ch) {
+        auto *data = hf.getChannelPointer(ch);
+        for (size_t i = 0; i < hf.getNumSamples(); ++i)
+          data[i] = data[i] + SampleType(0.5) * data[i] * data[i];
+      }
+    };
+
+    if (oversampler != nullptr) {
+      // Only the band above 15kHz is oversampled, where x^2 would alias
+      auto upBlock = oversampler->processSamplesUp(block);
+      saturate(upBlock);
+      oversampler->processSamplesDown(block);
+    } else {
+      saturate(block);
+    }
+
+    // Per-sample gain and mix only while the gain is moving
+    const auto *gainDBRamp = gainDB.getNextBlock(chunk);
+    if (gainDBRamp != nullptr) {
+      const auto log2PerDecibel = SampleType(1) / FastMath::decibelsPerLog2;
+      for (int i = 0; i < chunk; ++i) {
+        gainRamp[(size_t)i] = FastMath::exp2(gainDBRamp[i] * log2PerDecibel);
+        mixRamp[(size_t)i] = getMixAmount(gainDBRamp[i]);
+      }
+    }
+
+    auto gainLinear = juce::Decibels::decibelsToGain(gainDB.getCurrentValue());
+    auto mixAmount = getMixAmount(gainDB.getCurrentValue());
+
+    for (int ch = 0; ch < numChannels; ++ch) {
+      const auto *saturated = highFreqBuffer.getReadPointer(ch);
+      auto *outData = buffer.getWritePointer(ch, start);
+
+      if (dryDelaySamples > 0) {
+        for (int i = 0; i < chunk; ++i) {
+          dryDelay.pushSample(ch, outData[i]);
+          outData[i] = dryDelay.popSample(ch);
+        }
+      }
+
+      // Mix back into original signal
       // Output = Original * Gain + SaturatedHighs * Mix
-      outData[i] = origData[i] * gainLinear + saturated * mixAmount;
+      if (gainDBRamp != nullptr) {
+        for (int i = 0; i < chunk; ++i)
+          outData[i] = outData[i] * gainRamp[(size_t)i] +
+                       saturated[i] * mixRamp[(size_t)i];
+      } else {
+        for (int i = 0; i < chunk; ++i)
+          outData[i] = outData[i] * gainLinear + saturated[i] * mixAmount;
+      }
+
+      if (fadeStep != 0) {
+        auto level = switchFadeLevel;
+        for (int i = 0; i < chunk; ++i) {
+          level = juce::jlimit(0, switchFadeLength, level + fadeStep);
+          outData[i] *= (SampleType)level / (SampleType)switchFadeLength;
+        }
+      }
     }
+
+    switchFadeLevel = juce::jlimit(0, switchFadeLength,
+                                   switchFadeLevel + fadeStep * chunk);
   }
 }
+
+template <typename SampleType>
+void CrystallineSaturation<SampleType>::skipSilence(int numSamples,
+                                                    float inputGainDB) {
+  gainDB.setTargetValue((SampleType)inputGainDB);
+  gainDB.skip(numSamples);
+
+  // Clearing the oversampler touches a fair bit of memory, so only do it
+  // once per silent stretch. A pending factor change needs no fade here.
+  if (!filtersAtRest || pendingIndex != oversamplingIndex)
+    reset();
+}
+
+template <typename SampleType> void CrystallineSaturation<SampleType>::reset() {
+  highPassFilter.reset();
+  for (auto &oversampler : oversamplers)
+    if (oversampler != nullptr)
+      oversampler->reset();
+  switchOversampling();
+  switchFadeLevel = switchFadeLength;
+  filtersAtRest = true;
+}
+
+template class CrystallineSaturation<float>;
+template class CrystallineSaturation<double>;
@@ -1,15 +1,78 @@
 #pragma once
+#include "BiquadFilter.h"
+#include "FastMath.h"
+#include "SmoothedParameter.h"
 #include <JuceHeader.h>
 
-class CrystallineSaturation {
+// Instantiated for float and double in CrystallineSaturation.cpp
+template <typename SampleType> class CrystallineSaturation {
 public:
   CrystallineSaturation();
-  void prepare(double sampleRate, int samplesPerBlock);
+  void prepare(double sampleRate, int samplesPerBlock, int numChannels);
+  // Clears the high-pass, the oversamplers and the dry delay, and puts a
+  // pending oversampling change into effect without a fade
+  void reset();
+
+  // Oversampling of the high-passed band only: 0 = 1x, 1 = 2x, 2 = 4x.
+  // The dry path stays at the base rate and is delayed to line up.
+  // Mid-stream changes fade the output out and back in around the switch
+  // (switchFadeSeconds each way); after prepare() or reset() they're
+  // immediate.
+  void setOversampling(int factorIndex);
+  // Latency of the requested factor, which may still be fading in
+  int getLatencySamples() const { return latencySamples; }
 
   // Process modifies the buffer in-place
-  void process(juce::AudioBuffer<float> &buffer, float inputGainDB);
+  void process(juce::AudioBuffer<SampleType> &buffer, float inputGainDB);
+
+  // Stands in for process() on numSamples of silence once the filters and
+  // the dry delay have rung out; clears their state and advances the gain
+  // ramp
+  void skipSilence(int numSamples, float inputGainDB);
 
 private:
+  static constexpr int maxOversamplingIndex = 2;
+  static constexpr double switchFadeSeconds = 0.0025;
+
+  // Puts pendingIndex into effect: clears the new oversampler and the dry
+  // delay, which both restart from silence
+  void switchOversampling();
+
+  // The amount of saturation is proportional to the Gain parameter
+  // If Gain is high, we add more "Air" (max 10% mix at max gain)
+  static SampleType getMixAmount(SampleType gainDB) {
+    return SampleType(0.1) * std::max(SampleType(0), gainDB / SampleType(24));
+  }
+
   double sampleRate = 44100.0;
-  juce::dsp::IIR::Filter<float> highPassFilter;
+  // One filter state per channel, channels filtered side by side
+  BiquadFilter<SampleType> highPassFilter;
+
+  // High-frequency scratch, sized in prepare() so process() never allocates.
+  // Host blocks larger than this are processed in chunks.
+  juce::AudioBuffer<SampleType> highFreqBuffer;
+
+  // Polyphase half-band IIR oversamplers for 2x and 4x
+  std::unique_ptr<juce::dsp::Oversampling<SampleType>>
+      oversamplers[maxOversamplingIndex];
+  int oversamplingIndex = 0; // in effect
+  int pendingIndex = 0;       // requested by setOversampling()
+  int latencySamples = 0;     // of pendingIndex
+  int dryDelaySamples = 0;    // of oversamplingIndex
+
+  // Output level around a switch, in samples of the fade: switchFadeLength
+  // is full level, 0 is silence (where the switch happens)
+  int switchFadeLength = 1;
+  int switchFadeLevel = 1;
+  bool filtersAtRest = false; // cleared by reset(), until process()
+
+  // Keeps the base-rate dry path aligned with the oversampled band
+  juce::dsp::DelayLine<SampleType,
+                       juce::dsp::DelayLineInterpolationTypes::None>
+      dryDelay{64};
+
+  // Output gain in dB, ramped; the per-sample gain and mix are expanded
+  // into these while it moves
+  SmoothedParameter<SampleType> gainDB;
+  std::vector<SampleType> gainRamp, mixRamp;
 };
@@ -0,0 +1,101 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+// Level <-> log-domain conversions for the compressor's gain computer.
+//
+// The gain computer works in log2 units instead of dB (1 log2 unit =
+// 20*log10(2) dB), so the per-sample work is one log2 of the envelope and
+// one exp2 of the gain reduction.
+//
+// The fast kernels are branch-free polynomial approximations on the float
+// bit pattern and vectorize in the gain computer loop:
+//   fastLog2: 5th order on the mantissa, max abs error 6.3e-5 (0.00038 dB)
+//             for positive normal inputs. Zero and denormals return about
+//             -127, which is harmlessly far below any threshold.
+//   fastExp2: 4th order on the fraction, max rel error 3.7e-6 (0.00003 dB)
+//             for inputs in [-126, 126]. Callers clamp; a clamp in here
+//             would stop the loop from vectorizing.
+// Gain reduction is the level error scaled by (1 - 1/ratio), so the applied
+// gain is within 0.0004 dB of the exact path over the full
+// threshold (-60..0 dB) and ratio (1..20) range. Tools/FastMathCheck.cpp
+// checks all three bounds.
+//
+// The double overloads used by the 64-bit path are exact (std::log2 and
+// std::exp2): hosts running double precision expect it throughout, and a
+// float kernel would cap them at the float path's accuracy.
+//
+// Define EA_PURE_COMPRESSOR_FAST_MATH=0 to build with std::log2/std::exp2.
+#ifndef EA_PURE_COMPRESSOR_FAST_MATH
+#define EA_PURE_COMPRESSOR_FAST_MATH 1
+#endif
+
+namespace FastMath {
+
+// 20 * log10(2)
+constexpr float decibelsPerLog2 = 6.0205999f;
+
+// Largest gain reduction fastExp2 can represent, in log2 units
+constexpr float maxReductionLog2 = 126.0f;
+
+inline float fastLog2(float x) noexcept {
+  std::uint32_t bits;
+  std::memcpy(&bits, &x, sizeof(bits));
+
+  auto exponent = (float)((std::int32_t)(bits >> 23) - 127);
+
+  bits = (bits & 0x007fffffu) | 0x3f800000u; // mantissa in [1, 2)
+  float mantissa;
+  std::memcpy(&mantissa, &bits, sizeof(mantissa));
+
+  // log2(1 + t) ~= t * p(t) for t in [0, 1)
+  auto t = mantissa - 1.0f;
+  auto p = 0.0599455868f;
+  p = p * t - 0.2277126432f;
+  p = p * t + 0.4422741786f;
+  p = p * t - 0.7170639319f;
+  p = p * t + 1.4426156832f;
+  return exponent + t * p;
+}
+
+inline float fastExp2(float x) noexcept {
+  // floor() without a libm call so the loop stays vectorizable
+  auto whole = (std::int32_t)x;
+  whole -= (std::int32_t)(x < (float)whole);
+  auto f = x - (float)whole;
+
+  // 2^f for f in [0, 1)
+  auto p = 0.0136839829f;
+  p = p * f + 0.0517177355f;
+  p = p * f + 0.2416213227f;
+  p = p * f + 0.6929695509f;
+  p = p * f + 1.0000035971f;
+
+  auto scaleBits = (std::uint32_t)(whole + 127) << 23;
+  float scale;
+  std::memcpy(&scale, &scaleBits, sizeof(scale));
+  return p * scale;
+}
+
+inline float log2(float x) noexcept {
+#if EA_PURE_COMPRESSOR_FAST_MATH
+  return fastLog2(x);
+#else
+  return std::log2(x);
+#endif
+}
+
+inline float exp2(float x) noexcept {
+#if EA_PURE_COMPRESSOR_FAST_MATH
+  return fastExp2(x);
+#else
+  return std::exp2(x);
+#endif
+}
+
+inline double log2(double x) noexcept { return std::log2(x); }
+inline double exp2(double x) noexcept { return std::exp2(x); }
+
+} // namespace FastMath
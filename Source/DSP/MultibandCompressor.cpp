@@ -0,0 +1,230 @@
+#include "MultibandCompressor.h"
+
+template <typename SampleType>
+void MultibandCompressor<SampleType>::prepare(double sr, int samplesPerBlock,
+                                              int numChannels) {
+  sampleRate = sr;
+  maxBlockSize = juce::jmax(1, samplesPerBlock);
+  numChannels = juce::jmax(1, numChannels);
+
+  for (auto &engine : engines)
+    engine.prepare(sampleRate, maxBlockSize, numChannels);
+
+  for (auto *bands : {&bandBuffers, &keyBandBuffers})
+    for (auto &band : *bands)
+      band.setSize(numChannels, maxBlockSize);
+
+  juce::dsp::ProcessSpec spec{sampleRate, (juce::uint32)maxBlockSize,
+                              (juce::uint32)numChannels};
+  crossover.prepare(spec);
+  keyCrossover.prepare(spec);
+
+  // Re-apply the current crossovers at the new sample rate
+  auto low = lowMidHz > 0.0f ? lowMidHz : 200.0f;
+  auto high = midHighHz > 0.0f ? midHighHz : 3000.0f;
+  lowMidHz = midHighHz = 0.0f;
+  setCrossovers(low, high);
+}
+
+template <typename SampleType> void MultibandCompressor<SampleType>::reset() {
+  for (auto &engine : engines)
+    engine.reset();
+
+  crossover.reset();
+  keyCrossover.reset();
+}
+
+template <typename SampleType>
+void MultibandCompressor<SampleType>::setLookahead(float lookaheadMs) {
+  // Same delay in every band, or they wouldn't line up when summed
+  for (auto &engine : engines)
+    engine.setLookahead(lookaheadMs);
+}
+
+template <typename SampleType>
+void MultibandCompressor<SampleType>::setDetector(float rmsMix,
+                                                  float rmsWindowMs) {
+  for (auto &engine : engines)
+    engine.setDetector(rmsMix, rmsWindowMs);
+}
+
+template <typename SampleType>
+void MultibandCompressor<SampleType>::setProgramRelease(bool shouldBeOn) {
+  for (auto &engine : engines)
+    engine.setProgramRelease(shouldBeOn);
+}
+
+template <typename SampleType>
+void MultibandCompressor<SampleType>::setKeyFilter(float frequencyHz) {
+  for (auto &engine : engines)
+    engine.setKeyFilter(frequencyHz);
+}
+
+template <typename SampleType>
+void MultibandCompressor<SampleType>::setCrossovers(float newLowMidHz,
+                                                    float newMidHighHz) {
+  // Keep the mid band at least an octave wide and everything below Nyquist
+  auto maxHz = (float)(sampleRate * 0.45);
+  newMidHighHz = juce::jlimit(40.0f, maxHz, newMidHighHz);
+  newLowMidHz = juce::jlimit(20.0f, newMidHighHz * 0.5f, newLowMidHz);
+  if (newLowMidHz == lowMidHz && newMidHighHz == midHighHz)
+    return;
+
+  lowMidHz = newLowMidHz;
+  midHighHz = newMidHighHz;
+  crossover.setFrequencies(lowMidHz, midHighHz);
+  keyCrossover.setFrequencies(lowMidHz, midHighHz);
+}
+
+template <typename SampleType>
+void MultibandCompressor<SampleType>::process(
+    juce::AudioBuffer<SampleType> &buffer, const Bands &bands, float attackMs,
+    float releaseMs, juce::AudioBuffer<SampleType> *key) {
+  auto numChannels =
+      juce::jmin(buffer.getNumChannels(), bandBuffers[0].getNumChannels());
+  auto numSamples = buffer.getNumSamples();
+  if (numChannels == 0 || maxBlockSize == 0)
+    return;
+
+  auto numKeyChannels =
+      key != nullptr ? juce::jmin(key->getNumChannels(),
+                                  keyBandBuffers[0].getNumChannels())
+                     : 0;
+  jassert(key == nullptr || key->getNumSamples() >= numSamples);
+
+  // A key that comes back starts from silence, not from where it left off
+  if ((numKeyChannels > 0) != keyActive) {
+    keyActive = numKeyChannels > 0;
+    keyCrossover.reset();
+  }
+
+  std::array<float, numBands> thresholds, ratios;
+  for (int b = 0; b < numBands; ++b) {
+    thresholds[(size_t)b] = bands[(size_t)b].threshold;
+    ratios[(size_t)b] = bands[(size_t)b].ratio;
+  }
+
+  for (int start = 0; start < numSamples; start += maxBlockSize) {
+    auto chunk = juce::jmin(maxBlockSize, numSamples - start);
+    crossover.split(buffer, numChannels, start, chunk, bandBuffers);
+    if (numKeyChannels > 0)
+      keyCrossover.split(*key, numKeyChannels, start, chunk, keyBandBuffers);
+
+    // Views of the band buffers at this chunk's length
+    BandBuffers views, keyViews;
+    std::array<juce::AudioBuffer<SampleType> *, numBands> viewPointers,
+        keyPointers{};
+    std::array<CompressorEngine<SampleType> *, numBands> enginePointers;
+    for (size_t b = 0; b < (size_t)numBands; ++b) {
+      views[b] = juce::AudioBuffer<SampleType>(
+          bandBuffers[b].getArrayOfWritePointers(), numChannels, 0, chunk);
+      viewPointers[b] = &views[b];
+      enginePointers[b] = &engines[b];
+
+      if (numKeyChannels > 0) {
+        keyViews[b] = juce::AudioBuffer<SampleType>(
+            keyBandBuffers[b].getArrayOfWritePointers(), numKeyChannels, 0,
+            chunk);
+        keyPointers[b] = &keyViews[b];
+      }
+    }
+
+    CompressorEngine<SampleType>::processLanes(enginePointers, viewPointers,
+                                               thresholds, ratios, attackMs,
+                                               releaseMs, keyPointers);
+
+    // Sum the bands back into the host buffer
+    for (int ch = 0; ch < numChannels; ++ch) {
+      auto *out = buffer.getWritePointer(ch, start);
+      juce::FloatVectorOperations::add(out, bandBuffers[0].getReadPointer(ch),
+                                       bandBuffers[1].getReadPointer(ch),
+                                       chunk);
+      juce::FloatVectorOperations::add(out, bandBuffers[2].getReadPointer(ch),
+                                       chunk);
+    }
+  }
+
+  crossover.snapToZero();
+  if (numKeyChannels > 0)
+    keyCrossover.snapToZero();
+}
+
+template <typename SampleType>
+void MultibandCompressor<SampleType>::Crossover::prepare(
+    const juce::dsp::ProcessSpec &spec) {
+  lowMidSplit.prepare(spec);
+  midHighSplit.prepare(spec);
+  lowAllpass.setType(juce::dsp::LinkwitzRileyFilterType::allpass);
+  lowAllpass.prepare(spec);
+}
+
+template <typename SampleType>
+void MultibandCompressor<SampleType>::Crossover::reset() {
+  lowMidSplit.reset();
+  midHighSplit.reset();
+  lowAllpass.reset();
+}
+
+template <typename SampleType>
+void MultibandCompressor<SampleType>::Crossover::setFrequencies(
+    float lowMidHz, float midHighHz) {
+  lowMidSplit.setCutoffFrequency((SampleType)lowMidHz);
+  midHighSplit.setCutoffFrequency((SampleType)midHighHz);
+  lowAllpass.setCutoffFrequency((SampleType)midHighHz);
+}
+
+template <typename SampleType>
+void MultibandCompressor<SampleType>::Crossover::snapToZero() {
+  lowMidSplit.snapToZero();
+  midHighSplit.snapToZero();
+  lowAllpass.snapToZero();
+}
+
+template <typename SampleType>
+void MultibandCompressor<SampleType>::Crossover::split(
+    const juce::AudioBuffer<SampleType> &buffer, int numChannels, int start,
+    int numSamples, BandBuffers &bands) {
+  // The crossovers are serial per channel, so all three filters run in one
+  // pass over each channel
+  for (int ch = 0; ch < numChannels; ++ch) {
+    const auto *in = buffer.getReadPointer(ch, start);
+    auto *low = bands[0].getWritePointer(ch);
+    auto *mid = bands[1].getWritePointer(ch);
+    auto *high = bands[2].getWritePointer(ch);
+
+    for (int i = 0; i < numSamples; ++i) {
+      SampleType lowMid, rest;
+      lowMidSplit.processSample(ch, in[i], lowMid, rest);
+      midHighSplit.processSample(ch, rest, mid[i], high[i]);
+      low[i] = lowAllpass.processSample(ch, lowMid);
+    }
+  }
+}
+
+template <typename SampleType>
+void MultibandCompressor<SampleType>::skipSilence(int numSamples,
+                                                  const Bands &bands,
+                                                  float attackMs,
+                                                  float releaseMs) {
+  for (size_t b = 0; b < (size_t)numBands; ++b)
+    engines[b].skipSilence(numSamples, bands[b].threshold, attackMs,
+                           releaseMs);
+}
+
+template <typename SampleType>
+float MultibandCompressor<SampleType>::getBlockGainReductionDB() const {
+  return engines[(size_t)getMostReducedBand()].getBlockGainReductionDB();
+}
+
+template <typename SampleType>
+int MultibandCompressor<SampleType>::getMostReducedBand() const {
+  int band = 0;
+  for (int b = 1; b < numBands; ++b)
+    if (engines[(size_t)b].getBlockGainReductionDB() >
+        engines[(size_t)band].getBlockGainReductionDB())
+      band = b;
+  return band;
+}
+
+template class MultibandCompressor<float>;
+template class MultibandCompressor<double>;
@@ -0,0 +1,87 @@
+#pragma once
+#include "CompressorEngine.h"
+#include <JuceHeader.h>
+
+// Threshold and ratio of one band
+struct BandParameters {
+  float threshold = -10.0f;
+  float ratio = 2.0f;
+};
+
+// Three-band compressor: Linkwitz-Riley crossovers split the input into
+// low, mid and high, each band runs through its own CompressorEngine and
+// the bands are summed back.
+//
+// The low band also goes through an all-pass at the upper crossover, so the
+// three bands sum to a flat (all-pass) response when nothing compresses.
+// An external key is split through its own copy of the same crossovers, so
+// each band's detector hears the matching band of the key.
+// The band engines run in lock-step (CompressorEngine::processLanes), and
+// the band buffers are allocated in prepare(). Instantiated for float and
+// double in MultibandCompressor.cpp.
+template <typename SampleType> class MultibandCompressor {
+public:
+  static constexpr int numBands = 3;
+  using Bands = std::array<BandParameters, numBands>;
+
+  void prepare(double sampleRate, int samplesPerBlock, int numChannels);
+  void reset();
+
+  void setLookahead(float lookaheadMs);
+  int getLatencySamples() const { return engines[0].getLatencySamples(); }
+
+  // Detector and release settings for every band, see CompressorEngine
+  void setDetector(float rmsMix, float rmsWindowMs);
+  void setProgramRelease(bool shouldBeOn);
+  void setKeyFilter(float frequencyHz);
+
+  // Low/mid and mid/high crossover frequencies. Doesn't allocate.
+  void setCrossovers(float lowMidHz, float midHighHz);
+
+  // key, if given, feeds the band detectors instead of the input. It must
+  // be at least as long as buffer and is not modified; channels beyond the
+  // prepared count are ignored.
+  void process(juce::AudioBuffer<SampleType> &buffer, const Bands &bands,
+               float attackMs, float releaseMs,
+               juce::AudioBuffer<SampleType> *key = nullptr);
+
+  // See CompressorEngine::skipSilence()
+  void skipSilence(int numSamples, const Bands &bands, float attackMs,
+                   float releaseMs);
+
+  // Largest gain reduction of any band during the last process() call, and
+  // which band that was
+  float getBlockGainReductionDB() const;
+  int getMostReducedBand() const;
+
+private:
+  using BandBuffers = std::array<juce::AudioBuffer<SampleType>, numBands>;
+
+  // Filter states of one crossover network; the audio and the key each have
+  // their own
+  struct Crossover {
+    juce::dsp::LinkwitzRileyFilter<SampleType> lowMidSplit, midHighSplit,
+        lowAllpass;
+
+    void prepare(const juce::dsp::ProcessSpec &spec);
+    void reset();
+    void setFrequencies(float lowMidHz, float midHighHz);
+    void snapToZero();
+
+    // Splits numChannels x numSamples of buffer, from start, into bands
+    void split(const juce::AudioBuffer<SampleType> &buffer, int numChannels,
+               int start, int numSamples, BandBuffers &bands);
+  };
+
+  std::array<CompressorEngine<SampleType>, numBands> engines;
+
+  Crossover crossover, keyCrossover;
+  bool keyActive = false; // keyCrossover was fed by the last process()
+  float lowMidHz = 0.0f, midHighHz = 0.0f;
+  double sampleRate = 44100.0;
+
+  // One buffer per band, for the audio and for the key, maxBlockSize long;
+  // longer host blocks are processed in chunks
+  BandBuffers bandBuffers, keyBandBuffers;
+  int maxBlockSize = 0;
+};
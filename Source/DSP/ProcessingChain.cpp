@@ -0,0 +1,256 @@
+#include "ProcessingChain.h"
+
+template <typename SampleType>
+void ProcessingChain<SampleType>::prepare(double sr, int samplesPerBlock,
+                                          int numChannels) {
+  sampleRate = sr;
+  maxBlockSize = juce::jmax(1, samplesPerBlock);
+  numChannels = juce::jmax(1, numChannels);
+
+  compressor.prepare(sampleRate, maxBlockSize, numChannels);
+  coreProtect.prepare(sampleRate, maxBlockSize, numChannels);
+  saturation.prepare(sampleRate, maxBlockSize, numChannels);
+  multiband.prepare(sampleRate, maxBlockSize, numChannels);
+  multibandActive = false;
+  inputAccumulator.prepare(numChannels);
+  outputAccumulator.prepare(numChannels);
+
+  silentSamples = 0;
+  idle = false;
+
+  // Max lookahead plus the same oversampling allowance as the dry delay in
+  // CrystallineSaturation
+  auto maxLatency =
+      (int)std::ceil(CompressorEngine<SampleType>::maxLookaheadMs * 0.001 *
+                     sampleRate) +
+      64;
+  bypassDelay.setMaximumDelayInSamples(maxLatency);
+  bypassDelay.prepare({sampleRate, (juce::uint32)maxBlockSize,
+                       (juce::uint32)numChannels});
+  numBypassChannels = numChannels;
+  bypassed = false;
+}
+
+template <typename SampleType> void ProcessingChain<SampleType>::reset() {
+  compressor.reset();
+  multiband.reset();
+  coreProtect.reset();
+  saturation.reset();
+  silentSamples = 0;
+  idle = false;
+}
+
+template <typename SampleType>
+void ProcessingChain<SampleType>::process(
+    juce::AudioBuffer<SampleType> &buffer, const ChainParameters &params,
+    juce::AudioBuffer<SampleType> *key, int tileSize) {
+  gainReductionDB = 0.0f;
+  inputLevels = outputLevels = {};
+  if (maxBlockSize == 0)
+    return;
+
+  // The stages haven't seen the input during the bypass; start them from
+  // silence rather than resuming with the audio they held when it began
+  if (bypassed) {
+    bypassed = false;
+    reset();
+  }
+
+  compressor.setKeyFilter(params.keyFilterHz);
+  compressor.setDetector(params.rmsMix, params.rmsWindowMs);
+  compressor.setProgramRelease(params.programRelease);
+  multiband.setKeyFilter(params.keyFilterHz);
+  multiband.setDetector(params.rmsMix, params.rmsWindowMs);
+  multiband.setProgramRelease(params.programRelease);
+  multiband.setCrossovers(params.lowMidCrossoverHz, params.midHighCrossoverHz);
+
+  // Whichever compressor takes over starts from a clean slate rather than
+  // whatever it held when it was last switched off
+  if (params.multiband != multibandActive) {
+    multibandActive = params.multiband;
+    if (multibandActive)
+      multiband.reset();
+    else
+      compressor.reset();
+  }
+
+  // Everything still in flight (delayed audio, filter tails) has left the
+  // chain once the input has been silent for longer than this
+  auto numSamples = buffer.getNumSamples();
+  auto tailSamples =
+      getLatencySamples() + (juce::int64)(ringOutSeconds * sampleRate);
+
+  // Only a chain that has rung out checks the block for silence up front; a
+  // running one learns it from the input levels below. A live key keeps the
+  // chain running even under a silent input, so the envelope is where it
+  // should be when the input comes back.
+  idle = silentSamples >= tailSamples && isSilent(buffer) &&
+         (key == nullptr || isSilent(*key));
+
+  if (idle) {
+    silentSamples += numSamples;
+    buffer.clear();
+    coreProtect.skipSilence(numSamples, params.ratio);
+    compressor.skipSilence(numSamples, params.threshold, params.attack,
+                           params.release);
+    multiband.skipSilence(numSamples, params.bands, params.attack,
+                          params.release);
+    saturation.skipSilence(numSamples, params.gain);
+    return;
+  }
+
+  // CoreProtect's ratio curve covers at most one prepared block
+  tileSize = juce::jlimit(1, maxBlockSize, tileSize);
+  const float *effectiveRatios = nullptr;
+  inputAccumulator.clear();
+  outputAccumulator.clear();
+
+  processInTiles(
+      buffer, tileSize,
+      // 1. Core Protect (Dynamic Ratio Modulation)
+      // CoreProtect analyzes the signal and returns a per-sample ratio
+      [&](juce::AudioBuffer<SampleType> &tile, int) {
+        inputAccumulator.add(tile);
+        EA_PROFILE_STAGE(profiler, coreProtect);
+        if (!multibandActive) {
+          effectiveRatios = coreProtect.process(tile, params.ratio);
+          effectiveRatio = coreProtect.getEffectiveRatio();
+        }
+      },
+      // 2. Base Engine (VCA Compression), single or multiband
+      [&](juce::AudioBuffer<SampleType> &tile, int start) {
+        EA_PROFILE_STAGE(profiler, compressor);
+        juce::AudioBuffer<SampleType> keyTile;
+        if (key != nullptr)
+          keyTile = juce::AudioBuffer<SampleType>(
+              key->getArrayOfWritePointers(), key->getNumChannels(), start,
+              tile.getNumSamples());
+        auto *tileKey = key != nullptr ? &keyTile : nullptr;
+
+        if (multibandActive) {
+          multiband.process(tile, params.bands, params.attack, params.release,
+                            tileKey);
+          gainReductionDB =
+              std::max(gainReductionDB, multiband.getBlockGainReductionDB());
+          effectiveRatio =
+              params.bands[(size_t)multiband.getMostReducedBand()].ratio;
+          return;
+        }
+
+        compressor.process(tile, params.threshold, effectiveRatios,
+                           params.attack, params.release, tileKey);
+        gainReductionDB =
+            std::max(gainReductionDB, compressor.getBlockGainReductionDB());
+      },
+      // 3. Crystalline Saturation & Output Gain
+      [&](juce::AudioBuffer<SampleType> &tile, int) {
+        {
+          EA_PROFILE_STAGE(profiler, saturation);
+          saturation.process(tile, params.gain);
+        }
+        outputAccumulator.add(tile);
+      });
+
+  inputLevels = inputAccumulator.getLevels(numSamples);
+  outputLevels = outputAccumulator.getLevels(numSamples);
+
+  // The key is only looked at when the input is silent
+  if (inputAccumulator.isSilent() && (key == nullptr || isSilent(*key)))
+    silentSamples += numSamples;
+  else
+    silentSamples = 0;
+}
+
+template <typename SampleType>
+void ProcessingChain<SampleType>::processBypassed(
+    juce::AudioBuffer<SampleType> &buffer) {
+  auto latency = getLatencySamples();
+
+  // Start from silence rather than replaying the end of the last bypass
+  if (!bypassed) {
+    bypassDelay.reset();
+    bypassed = true;
+  }
+
+  if (latency == 0)
+    return;
+
+  bypassDelay.setDelay((SampleType)latency);
+
+  auto numChannels = juce::jmin(buffer.getNumChannels(), numBypassChannels);
+  for (int ch = 0; ch < numChannels; ++ch) {
+    auto *data = buffer.getWritePointer(ch);
+    for (int i = 0; i < buffer.getNumSamples(); ++i) {
+      bypassDelay.pushSample(ch, data[i]);
+      data[i] = bypassDelay.popSample(ch);
+    }
+  }
+}
+
+template <typename SampleType>
+bool ProcessingChain<SampleType>::isSilent(
+    const juce::AudioBuffer<SampleType> &buffer) const {
+  for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+    if (buffer.getMagnitude(ch, 0, buffer.getNumSamples()) >
+        (SampleType)silenceThreshold)
+      return false;
+
+  return true;
+}
+
+template <typename SampleType>
+void ProcessingChain<SampleType>::LevelAccumulator::prepare(int numChannels) {
+  peaks.assign((size_t)numChannels, SampleType(0));
+  sumSquares.assign((size_t)numChannels, 0.0);
+}
+
+template <typename SampleType>
+void ProcessingChain<SampleType>::LevelAccumulator::clear() {
+  std::fill(peaks.begin(), peaks.end(), SampleType(0));
+  std::fill(sumSquares.begin(), sumSquares.end(), 0.0);
+}
+
+template <typename SampleType>
+void ProcessingChain<SampleType>::LevelAccumulator::add(
+    const juce::AudioBuffer<SampleType> &tile) noexcept {
+  auto numChannels = juce::jmin(tile.getNumChannels(), (int)peaks.size());
+  for (int ch = 0; ch < numChannels; ++ch) {
+    const auto *data = tile.getReadPointer(ch);
+    auto peak = peaks[(size_t)ch];
+    auto sum = sumSquares[(size_t)ch];
+    for (int i = 0; i < tile.getNumSamples(); ++i) {
+      peak = std::max(peak, std::abs(data[i]));
+      sum += (double)data[i] * (double)data[i];
+    }
+    peaks[(size_t)ch] = peak;
+    sumSquares[(size_t)ch] = sum;
+  }
+}
+
+template <typename SampleType>
+typename ProcessingChain<SampleType>::Levels
+ProcessingChain<SampleType>::LevelAccumulator::getLevels(
+    int numSamples) const {
+  Levels levels;
+  if (numSamples <= 0)
+    return levels;
+
+  for (size_t ch = 0; ch < peaks.size(); ++ch) {
+    levels.peak = std::max(levels.peak, (float)peaks[ch]);
+    levels.rms = std::max(levels.rms,
+                          (float)std::sqrt(sumSquares[ch] / numSamples));
+  }
+  return levels;
+}
+
+template <typename SampleType>
+bool ProcessingChain<SampleType>::LevelAccumulator::isSilent() const {
+  for (auto peak : peaks)
+    if (peak > (SampleType)silenceThreshold)
+      return false;
+
+  return true;
+}
+
+template class ProcessingChain<float>;
+template class ProcessingChain<double>;
@@ -0,0 +1,160 @@
+#pragma once
+#include "CompressorEngine.h"
+#include "CoreProtect.h"
+#include "CrystallineSaturation.h"
+#include "MultibandCompressor.h"
+#include "StageProfiler.h"
+#include <JuceHeader.h>
+
+// Runs the buffer through every stage one tile at a time: all stages see
+// tile 0, then tile 1, and so on. The stages are fixed at compile time, so
+// the calls inline into one loop and a tile stays in cache from the first
+// stage to the last. Each stage is called as stage(tile, start), where tile
+// is an AudioBuffer referring into buffer (no copies) and start is its
+// offset in buffer.
+template <typename SampleType, typename... Stages>
+void processInTiles(juce::AudioBuffer<SampleType> &buffer, int tileSize,
+                    Stages &&...stages) {
+  auto numSamples = buffer.getNumSamples();
+  tileSize = juce::jmax(1, tileSize);
+
+  for (int start = 0; start < numSamples; start += tileSize) {
+    juce::AudioBuffer<SampleType> tile(
+        buffer.getArrayOfWritePointers(), buffer.getNumChannels(), start,
+        juce::jmin(tileSize, numSamples - start));
+    (stages(tile, start), ...);
+  }
+}
+
+struct ChainParameters {
+  float threshold = -10.0f;
+  float ratio = 2.0f;
+  float attack = 10.0f;
+  float release = 100.0f;
+  float gain = 0.0f;
+  float keyFilterHz = 0.0f; // detector high-pass, 0 = off
+  float rmsMix = 0.0f;      // detector: 0 = peak, 1 = RMS
+  float rmsWindowMs = 10.0f;
+  bool programRelease = false; // adds the slow release stage
+
+  // Multiband mode: the compressor stage becomes MultibandCompressor with
+  // its own per-band threshold and ratio. CoreProtect is not used there;
+  // the key and its high-pass feed every band's detector.
+  bool multiband = false;
+  float lowMidCrossoverHz = 200.0f, midHighCrossoverHz = 3000.0f;
+  MultibandCompressor<float>::Bands bands;
+};
+
+// CoreProtect -> CompressorEngine -> CrystallineSaturation.
+//
+// Every module streams, so splitting a block into tiles doesn't change the
+// output; the tile size only decides how much audio is in flight between
+// stages. Instantiated for float and double in ProcessingChain.cpp.
+//
+// Once the input has been silent for longer than the chain's tail the
+// output is silent too, and blocks skip the stages: each one only advances
+// its envelopes and ramps analytically.
+template <typename SampleType> class ProcessingChain {
+public:
+  // 256 samples of 16 double channels is 32 KB, so a tile survives in L1/L2
+  // across all three stages
+  static constexpr int defaultTileSize = 256;
+
+  // Allowance for the band-pass, high-pass and oversampling filters to ring
+  // out, on top of the latency
+  static constexpr double ringOutSeconds = 0.05;
+
+  void prepare(double sampleRate, int samplesPerBlock, int numChannels);
+  // Clears every stage's delays, filters and envelopes
+  void reset();
+
+  void setLookahead(float lookaheadMs) {
+    compressor.setLookahead(lookaheadMs);
+    multiband.setLookahead(lookaheadMs);
+  }
+  void setOversampling(int factorIndex) {
+    saturation.setOversampling(factorIndex);
+  }
+
+  // Stage timings go here when EA_PURE_COMPRESSOR_PROFILING is on. The
+  // caller times the whole block (StageProfiler::ScopedBlock).
+  void setProfiler(StageProfiler *newProfiler) { profiler = newProfiler; }
+  // Lookahead delay plus the oversampled high band's filter delay
+  int getLatencySamples() const {
+    return compressor.getLatencySamples() + saturation.getLatencySamples();
+  }
+
+  // key, if given, feeds the compressor's detector instead of the input
+  // (external sidechain), split into bands in multiband mode; it's read in
+  // place and left untouched.
+  // tileSize is clamped to the prepared block size. Passing the block size
+  // runs the stages one after the other over the whole block.
+  void process(juce::AudioBuffer<SampleType> &buffer,
+               const ChainParameters &params,
+               juce::AudioBuffer<SampleType> *key = nullptr,
+               int tileSize = defaultTileSize);
+
+  // The host's bypass: passes the input through delayed by the current
+  // latency so the track stays aligned. The stages are reset when
+  // process() resumes.
+  void processBypassed(juce::AudioBuffer<SampleType> &buffer);
+
+  // Peak and RMS of the loudest channel
+  struct Levels {
+    float peak = 0.0f, rms = 0.0f;
+  };
+
+  // Meter values from the last process() call. The levels are gathered
+  // tile by tile while the stages run, not in extra passes over the block.
+  float getGainReductionDB() const { return gainReductionDB; }
+  // In multiband mode, the ratio of the band that reduced the most
+  float getEffectiveRatio() const { return effectiveRatio; }
+  const Levels &getInputLevels() const { return inputLevels; }
+  const Levels &getOutputLevels() const { return outputLevels; }
+
+  // True if the last process() call took the silence fast path
+  bool isIdle() const { return idle; }
+
+private:
+  // About -160 dBFS, well under the LSB of 24-bit audio
+  static constexpr double silenceThreshold = 1.0e-8;
+
+  // Per-channel peak and sum of squares, added up tile by tile
+  struct LevelAccumulator {
+    std::vector<SampleType> peaks;
+    std::vector<double> sumSquares;
+
+    void prepare(int numChannels);
+    void clear();
+    void add(const juce::AudioBuffer<SampleType> &tile) noexcept;
+    Levels getLevels(int numSamples) const;
+    bool isSilent() const;
+  };
+
+  bool isSilent(const juce::AudioBuffer<SampleType> &buffer) const;
+
+  CompressorEngine<SampleType> compressor;
+  CoreProtect<SampleType> coreProtect;
+  CrystallineSaturation<SampleType> saturation;
+  MultibandCompressor<SampleType> multiband;
+  bool multibandActive = false;
+  StageProfiler *profiler = nullptr;
+
+  double sampleRate = 44100.0;
+  int maxBlockSize = 0;
+  float gainReductionDB = 0.0f;
+  float effectiveRatio = 1.0f;
+  LevelAccumulator inputAccumulator, outputAccumulator;
+  Levels inputLevels, outputLevels;
+
+  // Consecutive silent input samples, and whether we're skipping
+  juce::int64 silentSamples = 0;
+  bool idle = false;
+
+  // Dry delay for processBypassed(), long enough for the maximum latency
+  juce::dsp::DelayLine<SampleType,
+                       juce::dsp::DelayLineInterpolationTypes::None>
+      bypassDelay;
+  int numBypassChannels = 0;
+  bool bypassed = false;
+};
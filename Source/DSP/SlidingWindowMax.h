@@ -0,0 +1,65 @@
+#pragma once
+#include <JuceHeader.h>
+
+// Running maximum over the last `window` samples using a monotonic deque.
+//
+// Each sample is pushed and popped at most once, so the cost per sample is
+// constant regardless of the window length. Storage is allocated in
+// prepare() for the longest window; process() never allocates.
+template <typename SampleType> class SlidingWindowMax {
+public:
+  void prepare(int maxWindowLength) {
+    // The deque briefly holds window + 1 entries before the front is dropped
+    capacity = juce::jmax(1, maxWindowLength) + 1;
+    values.assign((size_t)capacity, SampleType(0));
+    positions.assign((size_t)capacity, 0);
+    reset();
+  }
+
+  void reset() {
+    head = 0;
+    count = 0;
+    position = 0;
+  }
+
+  void setWindowLength(int newLength) {
+    window = juce::jlimit(1, capacity - 1, newLength);
+  }
+
+  // Replaces each sample with the max of itself and the window - 1 samples
+  // before it
+  void process(SampleType *data, int numSamples) noexcept {
+    for (int i = 0; i < numSamples; ++i, ++position) {
+      auto x = data[i];
+
+      // Drop smaller values from the back; they can never be the max again
+      while (count > 0 && values[(size_t)wrap(head + count - 1)] <= x)
+        --count;
+
+      auto tail = (size_t)wrap(head + count);
+      values[tail] = x;
+      positions[tail] = position;
+      ++count;
+
+      // Drop the front once it has left the window (more than one entry
+      // may have expired if the window just shrank)
+      while (positions[(size_t)head] <= position - window) {
+        head = wrap(head + 1);
+        --count;
+      }
+
+      data[i] = values[(size_t)head];
+    }
+  }
+
+private:
+  int wrap(int index) const noexcept {
+    return index >= capacity ? index - capacity : index;
+  }
+
+  std::vector<SampleType> values;
+  std::vector<juce::int64> positions;
+  int capacity = 2, window = 1;
+  int head = 0, count = 0;
+  juce::int64 position = 0;
+};
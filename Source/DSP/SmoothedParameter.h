@@ -0,0 +1,67 @@
+#pragma once
+#include <JuceHeader.h>
+
+// juce::SmoothedValue that hands out its ramp a chunk at a time.
+//
+// While the value is steady getNextBlock() returns nullptr and callers use
+// getCurrentValue() as a constant, so a parameter that isn't moving costs
+// nothing per sample. While it ramps, the per-sample values are written into
+// a buffer allocated in prepare().
+template <typename SampleType,
+          typename SmoothingType = juce::ValueSmoothingTypes::Linear>
+class SmoothedParameter {
+public:
+  void prepare(double sampleRate, int maxBlockSize,
+               double rampLengthSeconds = 0.02) {
+    value.reset(sampleRate, rampLengthSeconds);
+    ramp.assign((size_t)juce::jmax(1, maxBlockSize), SampleType(0));
+    // Jump straight to the first target after a (re)prepare rather than
+    // ramping in from a stale value
+    primed = false;
+  }
+
+  void setTargetValue(SampleType newValue) noexcept {
+    if (!primed) {
+      value.setCurrentAndTargetValue(newValue);
+      primed = true;
+    } else {
+      value.setTargetValue(newValue);
+    }
+  }
+
+  SampleType getCurrentValue() const noexcept {
+    return value.getCurrentValue();
+  }
+
+  // Advances by numSamples without producing the ramp
+  void skip(int numSamples) noexcept { value.skip(numSamples); }
+
+  // Advances by numSamples (at most the prepared block size). Returns the
+  // per-sample values, or nullptr if the value is steady.
+  const SampleType *getNextBlock(int numSamples) noexcept {
+    if (!value.isSmoothing())
+      return nullptr;
+
+    jassert(numSamples <= (int)ramp.size());
+    for (int i = 0; i < numSamples; ++i)
+      ramp[(size_t)i] = value.getNextValue();
+    return ramp.data();
+  }
+
+  // Like getNextBlock(), but a steady value is written out too, for loops
+  // that want the same per-sample access either way
+  const SampleType *getNextBlockValues(int numSamples) noexcept {
+    if (const auto *values = getNextBlock(numSamples))
+      return values;
+
+    jassert(numSamples <= (int)ramp.size());
+    std::fill(ramp.begin(), ramp.begin() + numSamples,
+              value.getCurrentValue());
+    return ramp.data();
+  }
+
+private:
+  juce::SmoothedValue<SampleType, SmoothingType> value;
+  std::vector<SampleType> ramp;
+  bool primed = false;
+};
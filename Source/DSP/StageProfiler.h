@@ -0,0 +1,260 @@
+#pragma once
+#include <JuceHeader.h>
+
+// Per-stage timing for the audio callback. Off unless the build sets
+// EA_PURE_COMPRESSOR_PROFILING=1 (the CMake option of the same name). At 0
+// the timers are compiled out; the profiler itself stays so the editor still
+// builds, it just never receives any data.
+#ifndef EA_PURE_COMPRESSOR_PROFILING
+#define EA_PURE_COMPRESSOR_PROFILING 0
+#endif
+
+// Log-spaced histogram of durations: one thread records, any thread reads.
+//
+// Buckets are a quarter octave wide from 100 ns up to about 3 s, so a
+// percentile read back from it is within 19% of the true value.
+class LatencyHistogram {
+public:
+  static constexpr int bucketsPerOctave = 4;
+  static constexpr int numBuckets = 25 * bucketsPerOctave;
+  static constexpr double minNanoseconds = 100.0;
+
+  struct Snapshot {
+    std::array<juce::uint32, numBuckets> counts{};
+    juce::uint64 total = 0;
+    double maxNanoseconds = 0.0;
+
+    // Upper edge of the bucket holding the given fraction (0..1) of the
+    // recorded values, or 0 if nothing has been recorded
+    double getPercentile(double fraction) const {
+      if (total == 0)
+        return 0.0;
+
+      auto rank = (juce::uint64)std::ceil(fraction * (double)total);
+      juce::uint64 seen = 0;
+      for (int i = 0; i < numBuckets; ++i) {
+        seen += counts[(size_t)i];
+        if (seen >= juce::jmax((juce::uint64)1, rank))
+          return juce::jmin(getBucketUpperEdge(i), maxNanoseconds);
+      }
+      return maxNanoseconds;
+    }
+  };
+
+  // Recording thread only
+  void record(double nanoseconds) noexcept {
+    auto &count = counts[(size_t)getBucketIndex(nanoseconds)];
+    count.store(count.load(std::memory_order_relaxed) + 1,
+                std::memory_order_relaxed);
+
+    if (nanoseconds > maxNanoseconds.load(std::memory_order_relaxed))
+      maxNanoseconds.store(nanoseconds, std::memory_order_relaxed);
+  }
+
+  // Recording thread only, or while nothing records
+  void reset() noexcept {
+    for (auto &count : counts)
+      count.store(0, std::memory_order_relaxed);
+    maxNanoseconds.store(0.0, std::memory_order_relaxed);
+  }
+
+  // Any thread. Counts recorded during the copy may or may not be included.
+  Snapshot getSnapshot() const noexcept {
+    Snapshot s;
+    for (int i = 0; i < numBuckets; ++i) {
+      s.counts[(size_t)i] = counts[(size_t)i].load(std::memory_order_relaxed);
+      s.total += s.counts[(size_t)i];
+    }
+    s.maxNanoseconds = maxNanoseconds.load(std::memory_order_relaxed);
+    return s;
+  }
+
+  // Bucket 0 holds everything under minNanoseconds
+  static double getBucketUpperEdge(int index) noexcept {
+    return minNanoseconds * std::exp2((double)index / bucketsPerOctave);
+  }
+
+private:
+  static int getBucketIndex(double nanoseconds) noexcept {
+    if (!(nanoseconds > minNanoseconds))
+      return 0;
+    auto index = (int)std::ceil(std::log2(nanoseconds / minNanoseconds) *
+                                bucketsPerOctave);
+    return juce::jmin(index, numBuckets - 1);
+  }
+
+  std::array<std::atomic<juce::uint32>, numBuckets> counts{};
+  std::atomic<double> maxNanoseconds{0.0};
+};
+
+// Times each stage of the chain once per host block.
+//
+// Stages are timed per tile and summed over the block; the block's totals
+// go into one LatencyHistogram per stage and into a trace FIFO the editor
+// drains for the CSV dump. Recording is lock-free and allocation-free; the
+// audio thread is the only writer. Nothing is recorded until setEnabled()
+// turns it on, so only the debug overlay's open time is paid for.
+class StageProfiler {
+public:
+  enum Stage { coreProtect, compressor, saturation, total, numStages };
+
+  static const char *getStageName(int stage) {
+    static const char *const names[] = {"CoreProtect", "Compressor",
+                                        "Saturation", "Total"};
+    return names[juce::jlimit(0, (int)numStages - 1, stage)];
+  }
+
+  // One host block in the trace
+  struct BlockTiming {
+    std::array<float, numStages> nanoseconds{};
+    int numSamples = 0;
+  };
+
+  StageProfiler()
+      : nanosecondsPerTick(1.0e9 / (double)juce::Time::
+                                       getHighResolutionTicksPerSecond()) {}
+
+  // Clears the histograms. Call while the audio thread is stopped.
+  void prepare(double newSampleRate) {
+    sampleRate = newSampleRate;
+    for (auto &histogram : histograms)
+      histogram.reset();
+    deadlineNanoseconds.store(0.0);
+  }
+
+  // Message thread. Turning it on starts the histograms afresh; the reset
+  // itself happens in the next beginBlock(), since the audio thread is the
+  // only writer. Turning it off leaves them and the trace as they are.
+  void setEnabled(bool shouldBeEnabled) {
+    if (shouldBeEnabled && !isEnabled())
+      resetRequested.store(true, std::memory_order_relaxed);
+    enabled.store(shouldBeEnabled, std::memory_order_release);
+  }
+
+  bool isEnabled() const {
+    return enabled.load(std::memory_order_acquire);
+  }
+
+  // Audio thread. Blocks that begin while disabled record nothing.
+  void beginBlock(int numSamples) noexcept {
+    recording = isEnabled();
+    if (recording && resetRequested.exchange(false, std::memory_order_relaxed))
+      for (auto &histogram : histograms)
+        histogram.reset();
+    current = {};
+    current.numSamples = numSamples;
+  }
+
+  // Whether the current block is being timed
+  bool isRecording() const noexcept { return recording; }
+
+  void addTicks(Stage stage, juce::int64 ticks) noexcept {
+    current.nanoseconds[(size_t)stage] += (float)(ticks * nanosecondsPerTick);
+  }
+
+  void endBlock() noexcept {
+    if (!recording)
+      return;
+
+    for (int i = 0; i < numStages; ++i)
+      histograms[(size_t)i].record(current.nanoseconds[(size_t)i]);
+    deadlineNanoseconds.store(1.0e9 * current.numSamples / sampleRate,
+                              std::memory_order_relaxed);
+
+    // Dropped if nobody drains (editor closed)
+    if (trace.getFreeSpace() > 0)
+      trace.write(1).forEach(
+          [&](int index) { traceBlocks[(size_t)index] = current; });
+  }
+
+  // Any thread
+  const LatencyHistogram &getHistogram(int stage) const {
+    return histograms[(size_t)stage];
+  }
+
+  // Real time covered by the last block, i.e. the callback's deadline
+  double getDeadlineNanoseconds() const {
+    return deadlineNanoseconds.load(std::memory_order_relaxed);
+  }
+
+  // Message thread only. Calls fn for each traced block, oldest first.
+  template <typename Fn> int drainTrace(Fn &&fn) {
+    auto numReady = trace.getNumReady();
+    trace.read(numReady).forEach(
+        [&](int index) { fn(traceBlocks[(size_t)index]); });
+    return numReady;
+  }
+
+  // Adds the time from construction to destruction to a stage. A null or
+  // idle profiler makes it a no-op.
+  class ScopedStage {
+  public:
+    ScopedStage(StageProfiler *p, Stage s) noexcept
+        : profiler(p != nullptr && p->isRecording() ? p : nullptr), stage(s),
+          start(profiler != nullptr ? juce::Time::getHighResolutionTicks()
+                                    : 0) {}
+
+    ~ScopedStage() {
+      if (profiler != nullptr)
+        profiler->addTicks(stage,
+                           juce::Time::getHighResolutionTicks() - start);
+    }
+
+  private:
+    StageProfiler *profiler;
+    Stage stage;
+    juce::int64 start;
+
+    JUCE_DECLARE_NON_COPYABLE(ScopedStage)
+  };
+
+  // A whole host block: begins it, times it as the total and ends it
+  class ScopedBlock {
+  public:
+    ScopedBlock(StageProfiler &p, int numSamples) noexcept : profiler(p) {
+      profiler.beginBlock(numSamples);
+      if (profiler.isRecording())
+        start = juce::Time::getHighResolutionTicks();
+    }
+
+    ~ScopedBlock() {
+      if (profiler.isRecording())
+        profiler.addTicks(total,
+                          juce::Time::getHighResolutionTicks() - start);
+      profiler.endBlock();
+    }
+
+  private:
+    StageProfiler &profiler;
+    juce::int64 start = 0;
+
+    JUCE_DECLARE_NON_COPYABLE(ScopedBlock)
+  };
+
+private:
+  const double nanosecondsPerTick;
+  double sampleRate = 44100.0;
+
+  std::array<LatencyHistogram, numStages> histograms;
+  std::atomic<double> deadlineNanoseconds{0.0};
+  std::atomic<bool> enabled{false};
+  std::atomic<bool> resetRequested{false};
+  bool recording = false; // audio thread
+  BlockTiming current;
+
+  static constexpr int traceCapacity = 1024;
+  juce::AbstractFifo trace{traceCapacity};
+  std::array<BlockTiming, traceCapacity> traceBlocks;
+};
+
+#if EA_PURE_COMPRESSOR_PROFILING
+#define EA_PROFILE_BLOCK(profiler, numSamples)                                 \
+  const StageProfiler::ScopedBlock JUCE_JOIN_MACRO(profiledBlock_, __LINE__)(  \
+      profiler, numSamples)
+#define EA_PROFILE_STAGE(profiler, stage)                                      \
+  const StageProfiler::ScopedStage JUCE_JOIN_MACRO(profiledStage_, __LINE__)(  \
+      profiler, StageProfiler::stage)
+#else
+#define EA_PROFILE_BLOCK(profiler, numSamples)
+#define EA_PROFILE_STAGE(profiler, stage)
+#endif
@@ -0,0 +1,56 @@
+#include "EditorAssets.h"
+
+EditorAssets::EditorAssets() : juce::Thread("EditorAssets decoder") {
+  startThread(juce::Thread::Priority::low);
+}
+
+EditorAssets::~EditorAssets() {
+  // Decoding three PNGs is quick; let it finish rather than kill it
+  stopThread(-1);
+}
+
+void EditorAssets::run() {
+  auto decode = [](const void *data, int size) {
+    return juce::ImageFileFormat::loadFrom(data, (size_t)size);
+  };
+
+  background =
+      decode(BinaryData::background_png, BinaryData::background_pngSize);
+  jassert(background.getWidth() == backgroundWidth &&
+          background.getHeight() == backgroundHeight);
+  if (threadShouldExit())
+    return;
+
+  knobMetal =
+      decode(BinaryData::knob_metal_png, BinaryData::knob_metal_pngSize);
+  knobBlack =
+      decode(BinaryData::knob_black_png, BinaryData::knob_black_pngSize);
+
+  loaded.store(true, std::memory_order_release);
+  sendChangeMessage();
+}
+
+juce::Image EditorAssets::getBackground(float scale) {
+  JUCE_ASSERT_MESSAGE_THREAD
+
+  if (!isLoaded() || !background.isValid())
+    return {};
+
+  for (auto &variant : backgroundVariants)
+    if (variant.scale == scale)
+      return variant.image;
+
+  auto width = juce::jmax(1, juce::roundToInt(backgroundWidth * scale));
+  auto height = juce::jmax(1, juce::roundToInt(backgroundHeight * scale));
+  auto image = width == background.getWidth() &&
+                       height == background.getHeight()
+                   ? background
+                   : background.rescaled(width, height,
+                                         juce::Graphics::highResamplingQuality);
+  image = juce::NativeImageType().convert(image);
+
+  if (backgroundVariants.size() >= maxBackgroundVariants)
+    backgroundVariants.erase(backgroundVariants.begin());
+  backgroundVariants.push_back({scale, image});
+  return image;
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <JuceHeader.h>
+
+// Editor images, shared by every editor in the process.
+//
+// Hold one through juce::SharedResourcePointer<EditorAssets>: the first
+// holder creates it and decodes the PNGs on a background thread, so later
+// editors (in this or any other plugin instance) find them ready. Listeners
+// get a change message once decoding has finished. Every processor holds
+// one too, so the images stay decoded while the plugin is loaded, with or
+// without an editor open; the last instance going away frees them.
+//
+// Apart from the decoding, everything runs on the message thread.
+class EditorAssets : public juce::ChangeBroadcaster, private juce::Thread {
+public:
+  // Size of background.png, which is also the editor's size
+  static constexpr int backgroundWidth = 1024, backgroundHeight = 614;
+
+  EditorAssets();
+  ~EditorAssets() override;
+
+  bool isLoaded() const { return loaded.load(std::memory_order_acquire); }
+
+  // Invalid until isLoaded()
+  juce::Image getKnobMetal() const { return isLoaded() ? knobMetal : Image(); }
+  juce::Image getKnobBlack() const { return isLoaded() ? knobBlack : Image(); }
+
+  // The background at the physical pixel size for a display scale factor,
+  // in the platform's native format, so drawing it is a plain blit. One
+  // variant is kept per scale.
+  juce::Image getBackground(float scale);
+
+private:
+  using Image = juce::Image;
+
+  void run() override;
+
+  juce::Image background, knobMetal, knobBlack; // written before loaded
+  std::atomic<bool> loaded{false};
+
+  // A handful is plenty: one per monitor scale the editor has been on
+  static constexpr size_t maxBackgroundVariants = 4;
+  struct Variant {
+    float scale;
+    juce::Image image;
+  };
+  std::vector<Variant> backgroundVariants;
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(EditorAssets)
+};
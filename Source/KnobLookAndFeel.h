@@ -5,28 +5,40 @@ class KnobLookAndFeel : public juce::LookAndFeel_V4 {
 public:
   KnobLookAndFeel() {}
 
-  void setImage(const juce::Image &img) { knobImage = img; }
+  void setImage(const juce::Image &img) {
+    knobImage = img;
+    filmstrips.clear();
+  }
 
   void drawRotarySlider(juce::Graphics &g, int x, int y, int width, int height,
                         float sliderPos, const float rotaryStartAngle,
                         const float rotaryEndAngle,
                         juce::Slider &slider) override {
     if (knobImage.isValid()) {
-      const float angle =
-          rotaryStartAngle + sliderPos * (rotaryEndAngle - rotaryStartAngle);
-
       // Calculate scale to fit
       float scale = std::min((float)width / knobImage.getWidth(),
                              (float)height / knobImage.getHeight());
 
-      auto transform =
-          juce::AffineTransform::rotation(angle, knobImage.getWidth() / 2.0f,
-                                          knobImage.getHeight() / 2.0f)
-              .scaled(scale)
-              .translated(x + (width - knobImage.getWidth() * scale) / 2.0f,
-                          y + (height - knobImage.getHeight() * scale) / 2.0f);
+      auto knobArea =
+          juce::Rectangle<float>(knobImage.getWidth() * scale,
+                                 knobImage.getHeight() * scale)
+              .withCentre(juce::Rectangle<int>(x, y, width, height)
+                              .toFloat()
+                              .getCentre());
+
+      // Frames are rendered at the physical pixel size, so drawing one is a
+      // plain blit rather than a rotate-and-resample of the source image
+      auto pixelScale = g.getInternalContext().getPhysicalPixelScaleFactor();
+      auto &filmstrip =
+          getFilmstrip(juce::roundToInt(knobArea.getWidth() * pixelScale),
+                       juce::roundToInt(knobArea.getHeight() * pixelScale),
+                       rotaryStartAngle, rotaryEndAngle);
+
+      auto frameIndex = juce::jlimit(
+          0, numFrames - 1, juce::roundToInt(sliderPos * (numFrames - 1)));
 
-      g.drawImageTransformed(knobImage, transform);
+      g.drawImage(filmstrip.getFrame(frameIndex, knobImage), knobArea,
+                  juce::RectanglePlacement::stretchToFit);
     } else {
       // Fallback
       juce::LookAndFeel_V4::drawRotarySlider(g, x, y, width, height, sliderPos,
@@ -36,5 +48,69 @@ public:
   }
 
 private:
+  // 128 steps over the 270 degree sweep, about 2 degrees per frame
+  static constexpr int numFrames = 128;
+
+  // Strips kept at once, least recently drawn dropped first. Enough for
+  // every knob size this look-and-feel draws on a couple of displays; the
+  // rest (e.g. sizes passed through while resizing) are evicted.
+  static constexpr size_t maxFilmstrips = 4;
+
+  // Pre-rotated knob frames for one on-screen size and rotary range. Frames
+  // are rendered the first time they are shown and then reused, so memory
+  // only grows with the positions the knob actually visits.
+  struct Filmstrip {
+    int width = 0, height = 0;
+    float startAngle = 0.0f, endAngle = 0.0f;
+    std::array<juce::Image, numFrames> frames;
+
+    const juce::Image &getFrame(int index, const juce::Image &source) {
+      auto &frame = frames[(size_t)index];
+      if (!frame.isValid()) {
+        frame = juce::Image(juce::Image::ARGB, width, height, true);
+        juce::Graphics fg(frame);
+
+        const float angle = startAngle + (float)index / (numFrames - 1) *
+                                             (endAngle - startAngle);
+        auto transform =
+            juce::AffineTransform::rotation(angle, source.getWidth() / 2.0f,
+                                            source.getHeight() / 2.0f)
+                .scaled((float)width / source.getWidth(),
+                        (float)height / source.getHeight());
+
+        fg.drawImageTransformed(source, transform);
+      }
+      return frame;
+    }
+  };
+
+  Filmstrip &getFilmstrip(int width, int height, float startAngle,
+                          float endAngle) {
+    width = juce::jmax(1, width);
+    height = juce::jmax(1, height);
+
+    // Most recently drawn at the back
+    for (auto it = filmstrips.begin(); it != filmstrips.end(); ++it) {
+      auto &strip = **it;
+      if (strip.width == width && strip.height == height &&
+          strip.startAngle == startAngle && strip.endAngle == endAngle) {
+        std::rotate(it, it + 1, filmstrips.end());
+        return strip;
+      }
+    }
+
+    // Each knob size or display scale gets its own strip
+    if (filmstrips.size() >= maxFilmstrips)
+      filmstrips.erase(filmstrips.begin());
+    auto strip = std::make_unique<Filmstrip>();
+    strip->width = width;
+    strip->height = height;
+    strip->startAngle = startAngle;
+    strip->endAngle = endAngle;
+    filmstrips.push_back(std::move(strip));
+    return *filmstrips.back();
+  }
+
   juce::Image knobImage;
+  std::vector<std::unique_ptr<Filmstrip>> filmstrips;
 };
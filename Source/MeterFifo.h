@@ -0,0 +1,49 @@
+#pragma once
+#include <JuceHeader.h>
+
+// One frame of metering, published by the audio thread once per block
+struct MeterFrame {
+  float gainReductionDB = 0.0f; // max gain reduction within the block
+  float inputPeak = 0.0f;
+  float inputRms = 0.0f;
+  float outputPeak = 0.0f;
+  float outputRms = 0.0f;
+  float effectiveRatio = 1.0f; // ratio chosen by CoreProtect
+};
+
+// Single-producer/single-consumer ring of meter frames.
+//
+// The audio thread pushes one frame per block without locking; the editor
+// drains everything that arrived since its last timer tick, so short peaks
+// between UI frames are never lost. If nobody drains (editor closed) new
+// frames are dropped rather than blocking the audio thread, so a newly
+// opened editor calls reset() first instead of replaying that backlog.
+class MeterFifo {
+public:
+  // Audio thread only
+  bool push(const MeterFrame &frame) noexcept {
+    if (fifo.getFreeSpace() == 0)
+      return false;
+
+    fifo.write(1).forEach([&](int index) { frames[(size_t)index] = frame; });
+    return true;
+  }
+
+  // Message thread only. Calls fn for each pending frame, oldest first, and
+  // returns how many were read.
+  template <typename Fn> int drain(Fn &&fn) {
+    auto numReady = fifo.getNumReady();
+    fifo.read(numReady).forEach(
+        [&](int index) { fn(frames[(size_t)index]); });
+    return numReady;
+  }
+
+  // Message thread only. Drops the pending frames from the reading side, so
+  // it is safe while the audio thread keeps pushing.
+  void reset() noexcept { fifo.read(fifo.getNumReady()); }
+
+private:
+  static constexpr int capacity = 512;
+  juce::AbstractFifo fifo{capacity};
+  std::array<MeterFrame, capacity> frames;
+};
@@ -4,9 +4,8 @@
 EaPureCompressorAudioProcessorEditor::EaPureCompressorAudioProcessorEditor(
     EaPureCompressorAudioProcessor &p)
     : juce::AudioProcessorEditor(&p), audioProcessor(p) {
-  auto bg = juce::ImageCache::getFromMemory(BinaryData::background_png,
-                                            BinaryData::background_pngSize);
-  setSize(bg.getWidth(), bg.getHeight());
+  setOpaque(true);
+  setSize(EditorAssets::backgroundWidth, EditorAssets::backgroundHeight);
 
   // Helper to setup sliders
   auto setupSlider = [this](juce::Slider &slider, juce::Label &label,
@@ -25,10 +24,11 @@ EaPureCompressorAudioProcessorEditor::EaPureCompressorAudioProcessorEditor(
                                                     paramId, slider);
   };
 
-  metalKnobLnf.setImage(juce::ImageCache::getFromMemory(
-      BinaryData::knob_metal_png, BinaryData::knob_metal_pngSize));
-  blackKnobLnf.setImage(juce::ImageCache::getFromMemory(
-      BinaryData::knob_black_png, BinaryData::knob_black_pngSize));
+  // Already decoded unless this is the first editor in the process
+  if (assets->isLoaded())
+    applyAssets();
+  else
+    assets->addChangeListener(this);
 
   setupSlider(thresholdSlider, thresholdLabel, thresholdAtt, "Threshold",
               "threshold");
@@ -58,28 +58,23 @@ EaPureCompressorAudioProcessorEditor::EaPureCompressorAudioProcessorEditor(
   attackLabel.setVisible(false);
   releaseLabel.setVisible(false);
 
-  // Disable interception if debug (hacky but works for drag)
-  // Actually, Editor::mouseDown will only be called if sliders don't intercept.
-  // So we must force them to not intercept in debug mode.
-  bool intercept = !debugMode;
-  thresholdSlider.setInterceptsMouseClicks(intercept, intercept);
-  ratioSlider.setInterceptsMouseClicks(intercept, intercept);
-  attackSlider.setInterceptsMouseClicks(intercept, intercept);
-  releaseSlider.setInterceptsMouseClicks(intercept, intercept);
-  gainSlider.setInterceptsMouseClicks(intercept, intercept);
-
   // Debug Label
   addAndMakeVisible(debugLabel);
   debugLabel.setColour(juce::Label::textColourId, juce::Colours::yellow);
   debugLabel.setColour(juce::Label::backgroundColourId,
                        juce::Colours::black.withAlpha(0.6f));
+  setDebugMode(debugMode);
 
+  // Frames queued while no editor was open are stale by now
+  audioProcessor.getMeterFifo().reset();
   startTimerHz(60); // Faster meter update (600Hz might be too much for UI, 60
                     // is standard smooth)
   setWantsKeyboardFocus(true);
 }
 
 EaPureCompressorAudioProcessorEditor::~EaPureCompressorAudioProcessorEditor() {
+  audioProcessor.getProfiler().setEnabled(false);
+  assets->removeChangeListener(this);
   thresholdSlider.setLookAndFeel(nullptr);
   ratioSlider.setLookAndFeel(nullptr);
   attackSlider.setLookAndFeel(nullptr);
@@ -87,14 +82,55 @@ EaPureCompressorAudioProcessorEditor::~EaPureCompressorAudioProcessorEditor() {
   gainSlider.setLookAndFeel(nullptr);
 }
 
-void EaPureCompressorAudioProcessorEditor::paint(juce::Graphics &g) {
-  auto bg = juce::ImageCache::getFromMemory(BinaryData::background_png,
-                                            BinaryData::background_pngSize);
-  g.drawImageAt(bg, 0, 0);
+void EaPureCompressorAudioProcessorEditor::applyAssets() {
+  metalKnobLnf.setImage(assets->getKnobMetal());
+  blackKnobLnf.setImage(assets->getKnobBlack());
+  repaint();
+}
 
-  // Meter Needle logic
-  auto w = getWidth();
-  auto h = getHeight();
+void EaPureCompressorAudioProcessorEditor::changeListenerCallback(
+    juce::ChangeBroadcaster *) {
+  assets->removeChangeListener(this);
+  applyAssets();
+}
+
+void EaPureCompressorAudioProcessorEditor::setDebugMode(bool shouldBeOn) {
+  debugMode = shouldBeOn;
+
+  // Disable interception if debug (hacky but works for drag)
+  // Actually, Editor::mouseDown will only be called if sliders don't intercept.
+  // So we must force them to not intercept in debug mode.
+  bool intercept = !debugMode;
+  thresholdSlider.setInterceptsMouseClicks(intercept, intercept);
+  ratioSlider.setInterceptsMouseClicks(intercept, intercept);
+  attackSlider.setInterceptsMouseClicks(intercept, intercept);
+  releaseSlider.setInterceptsMouseClicks(intercept, intercept);
+  gainSlider.setInterceptsMouseClicks(intercept, intercept);
+
+  debugLabel.setVisible(debugMode);
+
+  // Stage timings are only taken while the overlay is up. Closing it drops
+  // the trace.
+  auto &profiler = audioProcessor.getProfiler();
+  profiler.setEnabled(debugMode);
+  if (!debugMode) {
+    profiler.drainTrace([](const StageProfiler::BlockTiming &) {});
+    profileTrace.clear();
+    profileTrace.shrink_to_fit();
+  }
+
+  repaint();
+}
+
+void EaPureCompressorAudioProcessorEditor::paint(juce::Graphics &g) {
+  // The variant for this display's scale is already at the physical pixel
+  // size, so this is a 1:1 blit
+  auto background = assets->getBackground(
+      g.getInternalContext().getPhysicalPixelScaleFactor());
+  if (background.isValid())
+    g.drawImage(background, getLocalBounds().toFloat());
+  else
+    g.fillAll(juce::Colours::black);
 
   // Meter Needle logic
   // Use member bound
@@ -102,19 +138,7 @@ void EaPureCompressorAudioProcessorEditor::paint(juce::Graphics &g) {
 
   // Meter Drawing
   g.setColour(juce::Colours::red); // Red Needle
-  float currentGR = grLevel;
-  float normalizedGR = juce::jlimit(0.0f, 1.0f, currentGR / 20.0f);
-  float pivotX = meterArea.getCentreX();
-  float pivotY = meterArea.getBottom() + 10;
-  float needleLength = meterArea.getHeight() * 0.9f;
-
-  // 130 degrees total sweep = +/- 65 degrees from center
-  float maxAngle = juce::MathConstants<float>::pi * (65.0f / 180.0f);
-  float angle = maxAngle - (normalizedGR * 2.0f * maxAngle);
-
-  float endX = pivotX + std::sin(angle) * needleLength;
-  float endY = pivotY - std::cos(angle) * needleLength;
-  g.drawLine(pivotX, pivotY, endX, endY, 2.0f);
+  g.drawLine(getNeedleLine(grLevel), 2.0f);
 
   // DEBUG OVERLAY
   if (debugMode) {
@@ -129,7 +153,86 @@ void EaPureCompressorAudioProcessorEditor::paint(juce::Graphics &g) {
     g.drawRect(gainSlider.getBounds(), 1);
 
     g.drawText("METER AREA", meterArea, juce::Justification::centred, false);
+
+    auto toDB = [](float level) {
+      return juce::String(juce::Decibels::gainToDecibels(level), 1);
+    };
+    g.drawText("GR " + juce::String(meterFrame.gainReductionDB, 1) +
+                   " dB  In " + toDB(meterFrame.inputPeak) + "/" +
+                   toDB(meterFrame.inputRms) + "  Out " +
+                   toDB(meterFrame.outputPeak) + "/" +
+                   toDB(meterFrame.outputRms) + " dB (pk/rms)  Ratio " +
+                   juce::String(meterFrame.effectiveRatio, 2),
+               meterArea.withY(meterArea.getBottom()).withHeight(20),
+               juce::Justification::centred, false);
+
+    drawProfile(g, getLocalBounds().reduced(10).removeFromTop(100));
+  }
+}
+
+void EaPureCompressorAudioProcessorEditor::drawProfile(
+    juce::Graphics &g, juce::Rectangle<int> area) const {
+#if EA_PURE_COMPRESSOR_PROFILING
+  auto &profiler = audioProcessor.getProfiler();
+  auto deadline = profiler.getDeadlineNanoseconds();
+
+  auto toMicroseconds = [](double ns) { return juce::String(ns * 0.001, 1); };
+  auto toPercent = [deadline](double ns) {
+    return deadline > 0.0 ? juce::String(100.0 * ns / deadline, 1) : "-";
+  };
+
+  g.setColour(juce::Colours::black.withAlpha(0.6f));
+  g.fillRect(area.withWidth(520));
+  g.setColour(juce::Colours::yellow);
+
+  auto lineHeight = area.getHeight() / (StageProfiler::numStages + 1);
+  g.drawText("Stage          p50 / p99 / max us      % of " +
+                 toMicroseconds(deadline) + " us (p99 / max)",
+             area.removeFromTop(lineHeight), juce::Justification::left,
+             false);
+
+  for (int stage = 0; stage < StageProfiler::numStages; ++stage) {
+    auto s = profiler.getHistogram(stage).getSnapshot();
+    auto p99 = s.getPercentile(0.99);
+    g.drawText(juce::String(StageProfiler::getStageName(stage))
+                       .paddedRight(' ', 14) +
+                   toMicroseconds(s.getPercentile(0.5)) + " / " +
+                   toMicroseconds(p99) + " / " +
+                   toMicroseconds(s.maxNanoseconds) + "      " +
+                   toPercent(p99) + " / " + toPercent(s.maxNanoseconds),
+               area.removeFromTop(lineHeight), juce::Justification::left,
+               false);
   }
+#else
+  g.setColour(juce::Colours::yellow);
+  g.drawText("Profiling compiled out (EA_PURE_COMPRESSOR_PROFILING)",
+             area.removeFromTop(20), juce::Justification::left, false);
+#endif
+}
+
+juce::Line<float> EaPureCompressorAudioProcessorEditor::getNeedleLine(
+    float gainReductionDB) const {
+  float normalizedGR = juce::jlimit(0.0f, 1.0f, gainReductionDB / 20.0f);
+  float pivotX = meterBounds.getCentreX();
+  float pivotY = meterBounds.getBottom() + 10;
+  float needleLength = meterBounds.getHeight() * 0.9f;
+
+  // 130 degrees total sweep = +/- 65 degrees from center
+  float maxAngle = juce::MathConstants<float>::pi * (65.0f / 180.0f);
+  float angle = maxAngle - (normalizedGR * 2.0f * maxAngle);
+
+  float endX = pivotX + std::sin(angle) * needleLength;
+  float endY = pivotY - std::cos(angle) * needleLength;
+  return {pivotX, pivotY, endX, endY};
+}
+
+juce::Rectangle<int> EaPureCompressorAudioProcessorEditor::getNeedleArea(
+    float gainReductionDB) const {
+  auto needle = getNeedleLine(gainReductionDB);
+  // Pad for the line thickness and anti-aliasing
+  return juce::Rectangle<float>(needle.getStart(), needle.getEnd())
+      .expanded(3.0f)
+      .getSmallestIntegerContainer();
 }
 
 void EaPureCompressorAudioProcessorEditor::mouseMove(
@@ -144,11 +247,7 @@ void EaPureCompressorAudioProcessorEditor::mouseMove(
 // 1. UI Resolution
 void EaPureCompressorAudioProcessorEditor::resized() {
   // 1024 x 614
-  auto bg = juce::ImageCache::getFromMemory(BinaryData::background_png,
-                                            BinaryData::background_pngSize);
-  if (bg.isValid()) {
-    setSize(1024, 614);
-  }
+  setSize(EditorAssets::backgroundWidth, EditorAssets::backgroundHeight);
 
   // 2. Exact Coordinates (User Provided Dump)
   thresholdBounds = {111, 297, 194, 280};
@@ -254,6 +353,25 @@ void EaPureCompressorAudioProcessorEditor::mouseUp(const juce::MouseEvent &) {
 
 bool EaPureCompressorAudioProcessorEditor::keyPressed(
     const juce::KeyPress &key) {
+#if EA_PURE_COMPRESSOR_PROFILING || JUCE_DEBUG
+  // Cmd/Ctrl+Shift+D shows the debug overlay (profiling and debug builds)
+  if (key.getKeyCode() == 'D' && key.getModifiers().isCommandDown() &&
+      key.getModifiers().isShiftDown()) {
+    setDebugMode(!debugMode);
+    return true;
+  }
+#endif
+
+  if (debugMode && key.getKeyCode() == 'P') {
+    auto desktop =
+        juce::File::getSpecialLocation(juce::File::userDesktopDirectory);
+    writeProfile(desktop.getChildFile("EA_PURE_COMPRESSOR_PROFILE.csv"),
+                 desktop.getChildFile("EA_PURE_COMPRESSOR_HISTOGRAM.csv"));
+    debugLabel.setText("Profile saved to Desktop!",
+                       juce::dontSendNotification);
+    return true;
+  }
+
   if (debugMode && key.getKeyCode() == 'S') {
     juce::File desktop =
         juce::File::getSpecialLocation(juce::File::userDesktopDirectory);
@@ -296,8 +414,75 @@ bool EaPureCompressorAudioProcessorEditor::keyPressed(
   return false;
 }
 
+// Per-block trace plus the per-stage histograms, both as CSV
+void EaPureCompressorAudioProcessorEditor::writeProfile(
+    const juce::File &traceFile, const juce::File &histogramFile) const {
+  auto sampleRate = audioProcessor.getSampleRate();
+
+  juce::String trace = "block,samples,deadline_ns";
+  for (int stage = 0; stage < StageProfiler::numStages; ++stage)
+    trace << "," << juce::String(StageProfiler::getStageName(stage))
+                        .toLowerCase()
+          << "_ns";
+  trace << "\n";
+
+  for (size_t i = 0; i < profileTrace.size(); ++i) {
+    auto &block = profileTrace[i];
+    trace << juce::String((juce::int64)i) << "," << block.numSamples << ","
+          << juce::String(1.0e9 * block.numSamples / sampleRate, 0);
+    for (auto ns : block.nanoseconds)
+      trace << "," << juce::String(ns, 0);
+    trace << "\n";
+  }
+  traceFile.replaceWithText(trace);
+
+  auto &profiler = audioProcessor.getProfiler();
+  juce::String histogram = "stage,bucket_upper_ns,count\n";
+  for (int stage = 0; stage < StageProfiler::numStages; ++stage) {
+    auto s = profiler.getHistogram(stage).getSnapshot();
+    for (int i = 0; i < LatencyHistogram::numBuckets; ++i)
+      if (s.counts[(size_t)i] > 0)
+        histogram << StageProfiler::getStageName(stage) << ","
+                  << juce::String(LatencyHistogram::getBucketUpperEdge(i), 0)
+                  << "," << (int)s.counts[(size_t)i] << "\n";
+  }
+  histogramFile.replaceWithText(histogram);
+}
+
 void EaPureCompressorAudioProcessorEditor::timerCallback() {
-  float targetGR = audioProcessor.getGainReduction();
+  // Drain every block published since the last tick. Peaks and gain
+  // reduction take the max across blocks so transients between UI frames
+  // still reach the meter; RMS and ratio follow the latest block.
+  MeterFrame drained;
+  auto numFrames = audioProcessor.getMeterFifo().drain(
+      [&drained](const MeterFrame &frame) {
+        drained.gainReductionDB =
+            std::max(drained.gainReductionDB, frame.gainReductionDB);
+        drained.inputPeak = std::max(drained.inputPeak, frame.inputPeak);
+        drained.outputPeak = std::max(drained.outputPeak, frame.outputPeak);
+        drained.inputRms = frame.inputRms;
+        drained.outputRms = frame.outputRms;
+        drained.effectiveRatio = frame.effectiveRatio;
+      });
+
+  // Keep the recent per-block timings for the CSV dump, dropping the oldest
+  // half once the trace is full
+  if (debugMode)
+    audioProcessor.getProfiler().drainTrace(
+        [this](const StageProfiler::BlockTiming &block) {
+          if (profileTrace.size() >= maxProfileTraceBlocks)
+            profileTrace.erase(
+                profileTrace.begin(),
+                profileTrace.begin() +
+                    (std::ptrdiff_t)(maxProfileTraceBlocks / 2));
+          profileTrace.push_back(block);
+        });
+
+  // Hold the last reading while the host isn't processing
+  if (numFrames > 0)
+    meterFrame = drained;
+
+  float targetGR = meterFrame.gainReductionDB;
 
   // Attack/Release smoothing
   // 0.0 is no reduction (Right). Positive is reduction (Left).
@@ -307,10 +492,21 @@ void EaPureCompressorAudioProcessorEditor::timerCallback() {
   const float attackCoef = 0.3f;
   const float releaseCoef = 0.02f; // Slow return
 
+  const float previousGR = grLevel;
+
   if (targetGR > grLevel)
     grLevel += (targetGR - grLevel) * attackCoef;
   else
     grLevel += (targetGR - grLevel) * releaseCoef;
 
-  repaint();
+  // The debug overlay prints live values, so it needs full repaints
+  if (debugMode) {
+    repaint();
+    return;
+  }
+
+  // Otherwise only the needle moves: invalidate its old and new positions
+  // and skip the repaint entirely once it has settled
+  if (std::abs(grLevel - previousGR) > 0.001f)
+    repaint(getNeedleArea(previousGR).getUnion(getNeedleArea(grLevel)));
 }
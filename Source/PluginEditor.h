@@ -1,11 +1,13 @@
 #pragma once
 
+#include "EditorAssets.h"
 #include "KnobLookAndFeel.h"
 #include "PluginProcessor.h"
 #include <JuceHeader.h>
 
 class EaPureCompressorAudioProcessorEditor : public juce::AudioProcessorEditor,
-                                             public juce::Timer {
+                                             public juce::Timer,
+                                             private juce::ChangeListener {
 public:
   EaPureCompressorAudioProcessorEditor(EaPureCompressorAudioProcessor &);
   ~EaPureCompressorAudioProcessorEditor() override;
@@ -16,6 +18,8 @@ public:
   void mouseMove(const juce::MouseEvent &e) override;
 
 private:
+  void changeListenerCallback(juce::ChangeBroadcaster *) override;
+
   EaPureCompressorAudioProcessor &audioProcessor;
 
   // Attachments
@@ -31,9 +35,24 @@ private:
   KnobLookAndFeel metalKnobLnf;
   KnobLookAndFeel blackKnobLnf;
 
+  // Images shared with every other editor in the process. Until the first
+  // decode finishes the editor paints plain black and default knobs.
+  juce::SharedResourcePointer<EditorAssets> assets;
+  void applyAssets();
+
   // Debug
   bool debugMode = false;
   juce::Label debugLabel;
+  void setDebugMode(bool shouldBeOn);
+
+  // Stage timings: overlay, plus a trace of recent blocks for the 'P' dump
+  // (about 25 minutes at 512 samples / 44.1 kHz). Collected only while
+  // debugMode is on.
+  static constexpr size_t maxProfileTraceBlocks = 1 << 17;
+  std::vector<StageProfiler::BlockTiming> profileTrace;
+  void drawProfile(juce::Graphics &g, juce::Rectangle<int> area) const;
+  void writeProfile(const juce::File &traceFile,
+                    const juce::File &histogramFile) const;
 
   // Interactive Layout Helpers
   int selectedIndex = -1;
@@ -54,7 +73,10 @@ private:
   bool keyPressed(const juce::KeyPress &key) override;
 
   // Metering
+  juce::Line<float> getNeedleLine(float gainReductionDB) const;
+  juce::Rectangle<int> getNeedleArea(float gainReductionDB) const;
   float grLevel = 0.0f;
+  MeterFrame meterFrame; // latest drained from the processor
 
   JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(
       EaPureCompressorAudioProcessorEditor)
@@ -1,17 +1,57 @@
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
+#include "PluginState.h"
+#include "RealtimeGuard.h"
+
+// Detector high-pass per "keyhpf" choice, 0 = off
+static constexpr float keyFilterFrequencies[] = {0.0f, 60.0f, 120.0f, 250.0f};
+
+// Peak/RMS blend per "detector" choice
+static constexpr float detectorRmsMix[] = {0.0f, 1.0f, 0.5f};
+
+// Multiband parameter prefixes, low to high
+static const char *const bandNames[] = {"Low", "Mid", "High"};
 
 EaPureCompressorAudioProcessor::EaPureCompressorAudioProcessor()
 #ifndef JucePlugin_PreferredChannelConfigurations
     : AudioProcessor(
           BusesProperties()
               .withInput("Input", juce::AudioChannelSet::stereo(), true)
-              .withOutput("Output", juce::AudioChannelSet::stereo(), true)),
+              .withOutput("Output", juce::AudioChannelSet::stereo(), true)
+              .withInput("Sidechain", juce::AudioChannelSet::stereo(),
+                         false)),
 #endif
       apvts(*this, nullptr, "Parameters", createParameterLayout()) {
+  thresholdParam = apvts.getRawParameterValue("threshold");
+  ratioParam = apvts.getRawParameterValue("ratio");
+  attackParam = apvts.getRawParameterValue("attack");
+  releaseParam = apvts.getRawParameterValue("release");
+  gainParam = apvts.getRawParameterValue("gain");
+  lookaheadParam = apvts.getRawParameterValue("lookahead");
+  qualityParam = apvts.getRawParameterValue("quality");
+  sidechainParam = apvts.getRawParameterValue("sidechain");
+  keyFilterParam = apvts.getRawParameterValue("keyhpf");
+  detectorParam = apvts.getRawParameterValue("detector");
+  rmsWindowParam = apvts.getRawParameterValue("rmswindow");
+  autoReleaseParam = apvts.getRawParameterValue("autorelease");
+  multibandParam = apvts.getRawParameterValue("multiband");
+  lowCrossoverParam = apvts.getRawParameterValue("lowcross");
+  highCrossoverParam = apvts.getRawParameterValue("highcross");
+  for (size_t band = 0; band < bandThresholdParams.size(); ++band) {
+    auto id = juce::String(bandNames[band]).toLowerCase();
+    bandThresholdParams[band] = apvts.getRawParameterValue(id + "threshold");
+    bandRatioParams[band] = apvts.getRawParameterValue(id + "ratio");
+  }
+
+  floatChain.setProfiler(&profiler);
+  doubleChain.setProfiler(&profiler);
+
+  startTimerHz(10);
 }
 
-EaPureCompressorAudioProcessor::~EaPureCompressorAudioProcessor() {}
+EaPureCompressorAudioProcessor::~EaPureCompressorAudioProcessor() {
+  stopTimer();
+}
 
 juce::AudioProcessorValueTreeState::ParameterLayout
 EaPureCompressorAudioProcessor::createParameterLayout() {
@@ -36,6 +76,60 @@ EaPureCompressorAudioProcessor::createParameterLayout() {
   params.push_back(std::make_unique<juce::AudioParameterFloat>(
       "gain", "Gain", juce::NormalisableRange<float>(0.0f, 24.0f, 0.1f), 0.0f));
 
+  params.push_back(std::make_unique<juce::AudioParameterFloat>(
+      "lookahead", "Lookahead",
+      juce::NormalisableRange<float>(
+          0.0f, CompressorEngine<float>::maxLookaheadMs, 0.1f),
+      0.0f));
+
+  // Oversampling of the Crystalline Saturation high band
+  params.push_back(std::make_unique<juce::AudioParameterChoice>(
+      "quality", "Quality", juce::StringArray{"1x", "2x", "4x"}, 0));
+
+  // Detector key: the sidechain bus instead of the input (ducking)
+  params.push_back(std::make_unique<juce::AudioParameterBool>(
+      "sidechain", "Sidechain", false));
+
+  // High-pass on the detector path only, see keyFilterFrequencies
+  params.push_back(std::make_unique<juce::AudioParameterChoice>(
+      "keyhpf", "Key HPF",
+      juce::StringArray{"Off", "60 Hz", "120 Hz", "250 Hz"}, 0));
+
+  // Detector: peak, RMS over "rmswindow", or half of each
+  params.push_back(std::make_unique<juce::AudioParameterChoice>(
+      "detector", "Detector", juce::StringArray{"Peak", "RMS", "Blend"}, 0));
+  params.push_back(std::make_unique<juce::AudioParameterFloat>(
+      "rmswindow", "RMS Window",
+      juce::NormalisableRange<float>(
+          1.0f, CompressorEngine<float>::maxRmsWindowMs, 0.1f),
+      10.0f));
+
+  // Program-dependent release: sustained material releases slower
+  params.push_back(std::make_unique<juce::AudioParameterBool>(
+      "autorelease", "Auto Release", false));
+
+  // Multiband mode: three bands split at two crossovers, each with its own
+  // threshold and ratio (attack and release are shared)
+  params.push_back(std::make_unique<juce::AudioParameterBool>(
+      "multiband", "Multiband", false));
+
+  juce::NormalisableRange<float> crossoverRange(20.0f, 20000.0f, 1.0f);
+  crossoverRange.setSkewForCentre(1000.0f);
+  params.push_back(std::make_unique<juce::AudioParameterFloat>(
+      "lowcross", "Low/Mid Crossover", crossoverRange, 200.0f));
+  params.push_back(std::make_unique<juce::AudioParameterFloat>(
+      "highcross", "Mid/High Crossover", crossoverRange, 3000.0f));
+
+  for (int band = 0; band < MultibandCompressor<float>::numBands; ++band) {
+    auto id = juce::String(bandNames[band]).toLowerCase();
+    params.push_back(std::make_unique<juce::AudioParameterFloat>(
+        id + "threshold", juce::String(bandNames[band]) + " Threshold",
+        juce::NormalisableRange<float>(-60.0f, 0.0f, 0.1f), -10.0f));
+    params.push_back(std::make_unique<juce::AudioParameterFloat>(
+        id + "ratio", juce::String(bandNames[band]) + " Ratio",
+        juce::NormalisableRange<float>(1.0f, 20.0f, 0.1f), 2.0f));
+  }
+
   return {params.begin(), params.end()};
 }
 
@@ -68,27 +162,86 @@ bool EaPureCompressorAudioProcessor::isMidiEffect() const {
 }
 
 double EaPureCompressorAudioProcessor::getTailLengthSeconds() const {
-  return 0.0;
+  // Delayed audio and filter ring-out, plus the release settling 60 dB
+  // (ln 1000 time constants) so the envelope is at rest before a host
+  // suspends us
+  auto sampleRate = getSampleRate() > 0.0 ? getSampleRate() : 44100.0;
+  auto releaseSeconds = releaseParam->load() * 0.001;
+  if (autoReleaseParam->load() > 0.5f)
+    releaseSeconds *= CompressorEngine<float>::slowReleaseFactor;
+
+  return getLatencySamples() / sampleRate +
+         ProcessingChain<float>::ringOutSeconds +
+         releaseSeconds * std::log(1000.0);
+}
+
+int EaPureCompressorAudioProcessor::getNumPrograms() {
+  return (int)PluginState::getFactoryPrograms().size();
 }
 
-int EaPureCompressorAudioProcessor::getNumPrograms() { return 1; }
+int EaPureCompressorAudioProcessor::getCurrentProgram() {
+  return currentProgram;
+}
 
-int EaPureCompressorAudioProcessor::getCurrentProgram() { return 0; }
+void EaPureCompressorAudioProcessor::setCurrentProgram(int index) {
+  auto &programs = PluginState::getFactoryPrograms();
+  if (!juce::isPositiveAndBelow(index, (int)programs.size()))
+    return;
 
-void EaPureCompressorAudioProcessor::setCurrentProgram(int index) {}
+  currentProgram = index;
+  PluginState::apply(apvts, programs[(size_t)index].values);
+}
 
 const juce::String EaPureCompressorAudioProcessor::getProgramName(int index) {
-  return {};
+  auto &programs = PluginState::getFactoryPrograms();
+  if (!juce::isPositiveAndBelow(index, (int)programs.size()))
+    return {};
+  return programs[(size_t)index].name;
 }
 
+// Factory programs are read-only
 void EaPureCompressorAudioProcessor::changeProgramName(
     int index, const juce::String &newName) {}
 
 void EaPureCompressorAudioProcessor::prepareToPlay(double sampleRate,
                                                    int samplesPerBlock) {
-  compressor.prepare(sampleRate, samplesPerBlock);
-  coreProtect.prepare(sampleRate, samplesPerBlock);
-  saturation.prepare(sampleRate, samplesPerBlock);
+  // The chains only ever see the main bus; the sidechain is read in place
+  auto numChannels = juce::jmax(getMainBusNumInputChannels(),
+                                getMainBusNumOutputChannels());
+
+  // Both chains are prepared: some hosts only pick the precision after
+  // prepareToPlay, and an unprepared chain must never see audio
+  prepareChain(floatChain, sampleRate, samplesPerBlock, numChannels);
+  prepareChain(doubleChain, sampleRate, samplesPerBlock, numChannels);
+  profiler.prepare(sampleRate);
+
+  if (isUsingDoublePrecision())
+    updateLatency(doubleChain);
+  else
+    updateLatency(floatChain);
+  reportLatency();
+}
+
+template <typename SampleType>
+void EaPureCompressorAudioProcessor::prepareChain(
+    ProcessingChain<SampleType> &chain, double sampleRate, int samplesPerBlock,
+    int numChannels) {
+  chain.prepare(sampleRate, samplesPerBlock, numChannels);
+  chain.setLookahead(lookaheadParam->load());
+  chain.setOversampling((int)qualityParam->load());
+}
+
+template <typename SampleType>
+void EaPureCompressorAudioProcessor::updateLatency(
+    const ProcessingChain<SampleType> &chain) {
+  auto latency = chain.getLatencySamples();
+  pendingLatency.store(latency, std::memory_order_relaxed);
+}
+
+void EaPureCompressorAudioProcessor::reportLatency() {
+  auto latency = pendingLatency.load(std::memory_order_relaxed);
+  if (latency != getLatencySamples())
+    setLatencySamples(latency);
 }
 
 void EaPureCompressorAudioProcessor::releaseResources() {}
@@ -96,11 +249,19 @@ void EaPureCompressorAudioProcessor::releaseResources() {}
 #ifndef JucePlugin_PreferredChannelConfigurations
 bool EaPureCompressorAudioProcessor::isBusesLayoutSupported(
     const BusesLayout &layouts) const {
-  if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono() &&
-      layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+  // Mono and stereo up to immersive beds such as 5.1, 7.1 and 7.1.4. The
+  // detector is linked across every channel, so any layout works as long
+  // as input and output match.
+  auto mainOut = layouts.getMainOutputChannelSet();
+  if (mainOut.isDisabled() || mainOut.size() > maxChannels)
+    return false;
+
+  if (mainOut != layouts.getMainInputChannelSet())
     return false;
 
-  if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
+  // Optional sidechain, any width up to the same limit
+  if (layouts.inputBuses.size() > 1 &&
+      layouts.getChannelSet(true, 1).size() > maxChannels)
     return false;
 
   return true;
@@ -109,6 +270,38 @@ bool EaPureCompressorAudioProcessor::isBusesLayoutSupported(
 
 void EaPureCompressorAudioProcessor::processBlock(
     juce::AudioBuffer<float> &buffer, juce::MidiBuffer &midiMessages) {
+  juce::ignoreUnused(midiMessages);
+  processChain(buffer, floatChain);
+}
+
+void EaPureCompressorAudioProcessor::processBlock(
+    juce::AudioBuffer<double> &buffer, juce::MidiBuffer &midiMessages) {
+  juce::ignoreUnused(midiMessages);
+  processChain(buffer, doubleChain);
+}
+
+void EaPureCompressorAudioProcessor::processBlockBypassed(
+    juce::AudioBuffer<float> &buffer, juce::MidiBuffer &midiMessages) {
+  juce::ignoreUnused(midiMessages);
+  const RealtimeGuard realtimeGuard;
+  auto mainBuffer = getBusBuffer(buffer, false, 0);
+  floatChain.processBypassed(mainBuffer);
+}
+
+void EaPureCompressorAudioProcessor::processBlockBypassed(
+    juce::AudioBuffer<double> &buffer, juce::MidiBuffer &midiMessages) {
+  juce::ignoreUnused(midiMessages);
+  const RealtimeGuard realtimeGuard;
+  auto mainBuffer = getBusBuffer(buffer, false, 0);
+  doubleChain.processBypassed(mainBuffer);
+}
+
+template <typename SampleType>
+void EaPureCompressorAudioProcessor::processChain(
+    juce::AudioBuffer<SampleType> &buffer,
+    ProcessingChain<SampleType> &chain) {
+  const RealtimeGuard realtimeGuard;
+  EA_PROFILE_BLOCK(profiler, buffer.getNumSamples());
   juce::ScopedNoDenormals noDenormals;
   auto totalNumInputChannels = getTotalNumInputChannels();
   auto totalNumOutputChannels = getTotalNumOutputChannels();
@@ -117,21 +310,56 @@ void EaPureCompressorAudioProcessor::processBlock(
     buffer.clear(i, 0, buffer.getNumSamples());
 
   // Get parameters
-  auto threshold = apvts.getRawParameterValue("threshold")->load();
-  auto ratio = apvts.getRawParameterValue("ratio")->load();
-  auto attack = apvts.getRawParameterValue("attack")->load();
-  auto release = apvts.getRawParameterValue("release")->load();
-  auto gain = apvts.getRawParameterValue("gain")->load();
-
-  // 1. Core Protect (Dynamic Ratio Modulation)
-  // CoreProtect analyzes the signal and returns a modified ratio
-  float effectiveRatio = coreProtect.process(buffer, ratio);
-
-  // 2. Base Engine (VCA Compression)
-  compressor.process(buffer, threshold, effectiveRatio, attack, release);
-
-  // 3. Crystalline Saturation & Output Gain
-  saturation.process(buffer, gain);
+  ChainParameters params;
+  params.threshold = thresholdParam->load();
+  params.ratio = ratioParam->load();
+  params.attack = attackParam->load();
+  params.release = releaseParam->load();
+  params.gain = gainParam->load();
+  params.keyFilterHz = keyFilterFrequencies[juce::jlimit(
+      0, (int)std::size(keyFilterFrequencies) - 1,
+      (int)keyFilterParam->load())];
+  params.rmsMix = detectorRmsMix[juce::jlimit(
+      0, (int)std::size(detectorRmsMix) - 1, (int)detectorParam->load())];
+  params.rmsWindowMs = rmsWindowParam->load();
+  params.programRelease = autoReleaseParam->load() > 0.5f;
+  params.multiband = multibandParam->load() > 0.5f;
+  params.lowMidCrossoverHz = lowCrossoverParam->load();
+  params.midHighCrossoverHz = highCrossoverParam->load();
+  for (size_t band = 0; band < params.bands.size(); ++band) {
+    params.bands[band].threshold = bandThresholdParams[band]->load();
+    params.bands[band].ratio = bandRatioParams[band]->load();
+  }
+
+  // Lookahead and oversampling add latency; reportLatency() keeps the host
+  // informed when either changes
+  chain.setLookahead(lookaheadParam->load());
+  chain.setOversampling((int)qualityParam->load());
+  updateLatency(chain);
+
+  // The main bus and the sidechain are views into the host buffer; nothing
+  // is copied
+  auto mainBuffer = getBusBuffer(buffer, false, 0);
+  auto sidechainBuffer = getBusCount(true) > 1
+                             ? getBusBuffer(buffer, true, 1)
+                             : juce::AudioBuffer<SampleType>();
+  auto useSidechain =
+      sidechainParam->load() > 0.5f && sidechainBuffer.getNumChannels() > 0;
+
+  // Core Protect -> VCA compression -> Crystalline Saturation & output
+  // gain, fused over cache-sized tiles
+  chain.process(mainBuffer, params, useSidechain ? &sidechainBuffer : nullptr);
+
+  // Publish this block's meters (lock-free, dropped if the editor is behind).
+  // The chain measured the levels while it ran.
+  MeterFrame meter;
+  meter.gainReductionDB = chain.getGainReductionDB();
+  meter.effectiveRatio = chain.getEffectiveRatio();
+  meter.inputPeak = chain.getInputLevels().peak;
+  meter.inputRms = chain.getInputLevels().rms;
+  meter.outputPeak = chain.getOutputLevels().peak;
+  meter.outputRms = chain.getOutputLevels().rms;
+  meterFifo.push(meter);
 }
 
 bool EaPureCompressorAudioProcessor::hasEditor() const { return true; }
@@ -142,13 +370,15 @@ juce::AudioProcessorEditor *EaPureCompressorAudioProcessor::createEditor() {
 
 void EaPureCompressorAudioProcessor::getStateInformation(
     juce::MemoryBlock &destData) {
-  auto state = apvts.copyState();
-  std::unique_ptr<juce::XmlElement> xml(state.createXml());
-  copyXmlToBinary(*xml, destData);
+  PluginState::write(apvts, currentProgram, destData);
 }
 
 void EaPureCompressorAudioProcessor::setStateInformation(const void *data,
                                                          int sizeInBytes) {
+  if (PluginState::read(apvts, data, sizeInBytes, currentProgram))
+    return;
+
+  // Sessions saved before the binary format
   std::unique_ptr<juce::XmlElement> xmlState(
       getXmlFromBinary(data, sizeInBytes));
   if (xmlState.get() != nullptr)
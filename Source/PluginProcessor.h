@@ -1,12 +1,16 @@
 #pragma once
 
-#include "DSP/CompressorEngine.h"
-#include "DSP/CoreProtect.h"
-#include "DSP/CrystallineSaturation.h"
+#include "DSP/ProcessingChain.h"
+#include "EditorAssets.h"
+#include "MeterFifo.h"
 #include <JuceHeader.h>
 
-class EaPureCompressorAudioProcessor : public juce::AudioProcessor {
+class EaPureCompressorAudioProcessor : public juce::AudioProcessor,
+                                       private juce::Timer {
 public:
+  // Widest supported bus (9.1.6)
+  static constexpr int maxChannels = 16;
+
   EaPureCompressorAudioProcessor();
   ~EaPureCompressorAudioProcessor() override;
 
@@ -18,6 +22,14 @@ public:
 #endif
 
   void processBlock(juce::AudioBuffer<float> &, juce::MidiBuffer &) override;
+  void processBlock(juce::AudioBuffer<double> &, juce::MidiBuffer &) override;
+  bool supportsDoublePrecisionProcessing() const override { return true; }
+
+  // Passes the audio through delayed by the reported latency
+  void processBlockBypassed(juce::AudioBuffer<float> &,
+                            juce::MidiBuffer &) override;
+  void processBlockBypassed(juce::AudioBuffer<double> &,
+                            juce::MidiBuffer &) override;
 
   juce::AudioProcessorEditor *createEditor() override;
   bool hasEditor() const override;
@@ -38,17 +50,61 @@ public:
   void getStateInformation(juce::MemoryBlock &destData) override;
   void setStateInformation(const void *data, int sizeInBytes) override;
 
-  float getGainReduction() const { return compressor.getGainReductionDB(); }
+  // Per-block meter frames for the editor to drain on the message thread
+  MeterFifo &getMeterFifo() { return meterFifo; }
+
+  // Per-stage callback timings for the editor's debug overlay
+  StageProfiler &getProfiler() { return profiler; }
 
   juce::AudioProcessorValueTreeState apvts;
 
 private:
   juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
 
-  // DSP Modules
-  CompressorEngine compressor;
-  CoreProtect coreProtect;
-  CrystallineSaturation saturation;
+  template <typename SampleType>
+  void prepareChain(ProcessingChain<SampleType> &chain, double sampleRate,
+                    int samplesPerBlock, int numChannels);
+  template <typename SampleType>
+  void processChain(juce::AudioBuffer<SampleType> &buffer,
+                    ProcessingChain<SampleType> &chain);
+  template <typename SampleType>
+  void updateLatency(const ProcessingChain<SampleType> &chain);
+
+  // Message thread: passes the latency last published by updateLatency()
+  // on to the host
+  void reportLatency();
+  void timerCallback() override { reportLatency(); }
+
+  // DSP Modules, one chain per sample type so both host precisions run
+  // natively without converting the buffer
+  ProcessingChain<float> floatChain;
+  ProcessingChain<double> doubleChain;
+
+  // Raw parameter values, looked up once in the constructor
+  std::atomic<float> *thresholdParam = nullptr, *ratioParam = nullptr,
+                     *attackParam = nullptr, *releaseParam = nullptr,
+                     *gainParam = nullptr, *lookaheadParam = nullptr,
+                     *qualityParam = nullptr, *sidechainParam = nullptr,
+                     *keyFilterParam = nullptr, *detectorParam = nullptr,
+                     *rmsWindowParam = nullptr, *autoReleaseParam = nullptr,
+                     *multibandParam = nullptr, *lowCrossoverParam = nullptr,
+                     *highCrossoverParam = nullptr;
+  std::array<std::atomic<float> *, MultibandCompressor<float>::numBands>
+      bandThresholdParams{}, bandRatioParams{};
+
+  MeterFifo meterFifo;
+  StageProfiler profiler;
+
+  // Held for the instance's lifetime, not just the editor's, so reopening an
+  // editor never decodes the images again
+  juce::SharedResourcePointer<EditorAssets> editorAssets;
+
+  // Latency as of the last updateLatency(). setLatencySamples() isn't called
+  // from the audio thread; reportLatency() does it on the message thread.
+  std::atomic<int> pendingLatency{0};
+
+  // Factory program last selected, saved with the state
+  int currentProgram = 0;
 
   JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(EaPureCompressorAudioProcessor)
 };
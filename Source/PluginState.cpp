@@ -0,0 +1,189 @@
+#include "PluginState.h"
+
+namespace PluginState {
+
+static const char magic[4] = {'E', 'A', 'P', 'C'};
+
+const std::vector<FactoryProgram> &getFactoryPrograms() {
+  // Choice parameters take the choice index, bools 0/1
+  static const std::vector<FactoryProgram> programs = {
+      {"Default", {}},
+      {"Gentle Glue",
+       {{"threshold", -18.0f},
+        {"ratio", 2.0f},
+        {"attack", 30.0f},
+        {"release", 200.0f},
+        {"gain", 2.0f},
+        {"detector", 2.0f},
+        {"autorelease", 1.0f}}},
+      {"Vocal Leveler",
+       {{"threshold", -24.0f},
+        {"ratio", 3.0f},
+        {"attack", 5.0f},
+        {"release", 120.0f},
+        {"gain", 4.0f},
+        {"detector", 1.0f},
+        {"rmswindow", 20.0f},
+        {"autorelease", 1.0f}}},
+      {"Drum Smash",
+       {{"threshold", -30.0f},
+        {"ratio", 10.0f},
+        {"attack", 1.0f},
+        {"release", 60.0f},
+        {"gain", 8.0f},
+        {"quality", 1.0f}}},
+      {"Peak Catcher",
+       {{"threshold", -6.0f},
+        {"ratio", 20.0f},
+        {"attack", 0.1f},
+        {"release", 50.0f},
+        {"lookahead", 5.0f},
+        {"quality", 2.0f}}},
+      {"Sidechain Duck",
+       {{"threshold", -30.0f},
+        {"ratio", 8.0f},
+        {"attack", 1.0f},
+        {"release", 150.0f},
+        {"sidechain", 1.0f},
+        {"keyhpf", 2.0f}}},
+      {"Multiband Master",
+       {{"multiband", 1.0f},
+        {"lowcross", 150.0f},
+        {"highcross", 4000.0f},
+        {"lowthreshold", -20.0f},
+        {"lowratio", 2.0f},
+        {"midthreshold", -18.0f},
+        {"midratio", 1.5f},
+        {"highthreshold", -22.0f},
+        {"highratio", 2.5f},
+        {"attack", 20.0f},
+        {"release", 150.0f},
+        {"autorelease", 1.0f},
+        {"gain", 1.0f}}},
+      {"Multiband De-Boom",
+       {{"multiband", 1.0f},
+        {"lowcross", 120.0f},
+        {"highcross", 5000.0f},
+        {"lowthreshold", -28.0f},
+        {"lowratio", 6.0f},
+        {"midthreshold", 0.0f},
+        {"midratio", 1.0f},
+        {"highthreshold", 0.0f},
+        {"highratio", 1.0f},
+        {"attack", 10.0f},
+        {"release", 100.0f}}},
+  };
+  return programs;
+}
+
+static juce::RangedAudioParameter *
+getRangedParameter(juce::AudioProcessorValueTreeState &apvts, int index) {
+  return dynamic_cast<juce::RangedAudioParameter *>(
+      apvts.processor.getParameters()[index]);
+}
+
+// Host notification only for parameters that actually move
+static void setNormalised(juce::RangedAudioParameter &param, float value) {
+  if (param.getValue() != value)
+    param.setValueNotifyingHost(value);
+}
+
+void write(juce::AudioProcessorValueTreeState &apvts, int currentProgram,
+           juce::MemoryBlock &destData) {
+  auto &params = apvts.processor.getParameters();
+
+  destData.reset();
+  juce::MemoryOutputStream out(destData, false);
+  out.write(magic, sizeof(magic));
+  out.writeShort((short)currentVersion);
+  out.writeShort((short)currentProgram);
+  out.writeShort((short)params.size());
+
+  for (int i = 0; i < params.size(); ++i) {
+    auto *param = getRangedParameter(apvts, i);
+    jassert(param != nullptr);
+
+    auto id = param->paramID.toRawUTF8();
+    auto length = juce::jmin((size_t)255, std::strlen(id));
+    out.writeByte((char)length);
+    out.write(id, length);
+    out.writeFloat(param->convertFrom0to1(param->getValue()));
+  }
+}
+
+bool read(juce::AudioProcessorValueTreeState &apvts, const void *data,
+          int sizeInBytes, int &currentProgram) {
+  const int headerSize = (int)sizeof(magic) + 3 * (int)sizeof(juce::uint16);
+  if (sizeInBytes < headerSize || std::memcmp(data, magic, sizeof(magic)) != 0)
+    return false;
+
+  juce::MemoryInputStream in(data, (size_t)sizeInBytes, false);
+  in.skipNextBytes(sizeof(magic));
+
+  auto version = (juce::uint16)in.readShort();
+  if (version == 0 || version > currentVersion)
+    return false;
+
+  auto program = (int)in.readShort();
+  auto numEntries = (int)(juce::uint16)in.readShort();
+
+  // Everything starts at its default; entries override
+  auto &params = apvts.processor.getParameters();
+  std::vector<float> values((size_t)params.size());
+  for (int i = 0; i < params.size(); ++i)
+    values[(size_t)i] = params[i]->getDefaultValue();
+
+  char id[256];
+  for (int entry = 0; entry < numEntries; ++entry) {
+    // Truncated blobs are rejected before anything is touched
+    if (in.getNumBytesRemaining() < 1)
+      return false;
+    auto length = (int)(juce::uint8)in.readByte();
+    if (in.getNumBytesRemaining() < length + (int)sizeof(float))
+      return false;
+    in.read(id, length);
+    id[length] = 0;
+    auto value = in.readFloat();
+
+    // Saved by the same build, entries line up with the parameter list;
+    // otherwise look the ID up
+    auto index = entry;
+    auto *param = index < params.size() ? getRangedParameter(apvts, index)
+                                        : nullptr;
+    if (param == nullptr || param->paramID != id) {
+      param = nullptr;
+      for (index = 0; index < params.size(); ++index)
+        if (auto *p = getRangedParameter(apvts, index); p->paramID == id) {
+          param = p;
+          break;
+        }
+    }
+
+    if (param != nullptr)
+      values[(size_t)index] = param->convertTo0to1(value);
+  }
+
+  for (int i = 0; i < params.size(); ++i)
+    setNormalised(*getRangedParameter(apvts, i), values[(size_t)i]);
+
+  currentProgram = program;
+  return true;
+}
+
+void apply(juce::AudioProcessorValueTreeState &apvts,
+           const std::vector<ParameterValue> &values) {
+  auto &params = apvts.processor.getParameters();
+
+  for (int i = 0; i < params.size(); ++i) {
+    auto *param = getRangedParameter(apvts, i);
+    auto value = param->getDefaultValue();
+
+    for (auto &v : values)
+      if (param->paramID == v.id)
+        value = param->convertTo0to1(v.value);
+
+    setNormalised(*param, value);
+  }
+}
+
+} // namespace PluginState
@@ -0,0 +1,49 @@
+#pragma once
+#include <JuceHeader.h>
+
+// Parameter state as a compact binary blob, and the factory programs.
+//
+// Layout, little endian:
+//   char[4]  magic "EAPC"
+//   uint16   version (currentVersion)
+//   int16    current program, -1 if none
+//   uint16   number of entries, then per entry:
+//              uint8 ID length, ID (UTF-8), float32 plain (unnormalised)
+//              value
+//
+// Values are keyed by parameter ID, so parameters can come and go between
+// versions: unknown IDs are skipped and parameters missing from the blob
+// go back to their defaults. Blobs without the magic are the old
+// XML-in-binary format and are read through the ValueTree as before.
+//
+// Restoring a state or switching programs sets the parameters one by one
+// (only those that change) instead of replacing the APVTS ValueTree.
+namespace PluginState {
+
+constexpr juce::uint16 currentVersion = 1;
+
+struct ParameterValue {
+  const char *id;
+  float value;
+};
+
+struct FactoryProgram {
+  const char *name;
+  std::vector<ParameterValue> values; // everything else at its default
+};
+
+const std::vector<FactoryProgram> &getFactoryPrograms();
+
+void write(juce::AudioProcessorValueTreeState &apvts, int currentProgram,
+           juce::MemoryBlock &destData);
+
+// Returns false, leaving the parameters alone, if data isn't a binary state
+// this version understands. currentProgram is set from the blob.
+bool read(juce::AudioProcessorValueTreeState &apvts, const void *data,
+          int sizeInBytes, int &currentProgram);
+
+// Sets the given values and resets every other parameter to its default
+void apply(juce::AudioProcessorValueTreeState &apvts,
+           const std::vector<ParameterValue> &values);
+
+} // namespace PluginState
@@ -0,0 +1,47 @@
+#pragma once
+#include <JuceHeader.h>
+
+#ifndef EA_PURE_COMPRESSOR_REALTIME_GUARD
+#define EA_PURE_COMPRESSOR_REALTIME_GUARD 0
+#endif
+
+// Marks a scope as real-time: no allocation, no locks, no blocking calls.
+//
+// With EA_PURE_COMPRESSOR_REALTIME_GUARD the guard sets a thread-local flag
+// that the hooks in Tools/RealtimeCheck.cpp look at (allocator, mutex and
+// syscalls); anything they intercept while the flag is set is a violation.
+// Without it (plugin builds) the guard compiles away.
+class RealtimeGuard {
+public:
+#if EA_PURE_COMPRESSOR_REALTIME_GUARD
+  RealtimeGuard() noexcept { ++depth(); }
+  ~RealtimeGuard() noexcept { --depth(); }
+
+  static bool isActive() noexcept { return depth() > 0 && suspended() == 0; }
+
+  // Lets the hooks do non-real-time work (reporting a violation) without
+  // tripping over themselves
+  struct ScopedSuspend {
+    ScopedSuspend() noexcept { ++suspended(); }
+    ~ScopedSuspend() noexcept { --suspended(); }
+  };
+
+private:
+  // Plain ints: thread-local access must not allocate from inside a hook
+  static int &depth() noexcept {
+    static thread_local int value = 0;
+    return value;
+  }
+
+  static int &suspended() noexcept {
+    static thread_local int value = 0;
+    return value;
+  }
+#else
+  RealtimeGuard() noexcept {}
+
+  static constexpr bool isActive() noexcept { return false; }
+#endif
+
+  JUCE_DECLARE_NON_COPYABLE(RealtimeGuard)
+};
@@ -0,0 +1,147 @@
+// Zero-allocation check for processBlock().
+//
+// Counts every heap allocation made on the calling thread while
+// processBlock() runs, over a sweep of sample rates, block sizes (shorter
+// than prepared, and 2x and 4x longer), both precisions and the main
+// parameter modes. Exits 1 if processBlock() allocated at all.
+//
+//   EA_PURE_COMPRESSOR_AllocationCheck [--blocks=<n>]
+//
+// Allocations are seen through the shared hooks in
+// Tools/AllocationHooks.cpp.
+
+#include "AllocationHooks.h"
+#include "PluginProcessor.h"
+#include <JuceHeader.h>
+#include <iostream>
+
+namespace {
+
+thread_local bool counting = false;
+std::atomic<int> numAllocations{0};
+
+} // namespace
+
+void onAllocation(const char *) noexcept {
+  if (counting)
+    numAllocations.fetch_add(1, std::memory_order_relaxed);
+}
+
+namespace {
+
+struct Mode {
+  const char *name;
+  std::vector<std::pair<const char *, float>> values; // plain values
+};
+
+const Mode modes[] = {
+    {"default", {}},
+    {"heavy", {{"threshold", -40.0f}, {"ratio", 10.0f}, {"gain", 12.0f}}},
+    {"lookahead", {{"threshold", -30.0f}, {"lookahead", 5.0f}}},
+    {"oversampled", {{"gain", 12.0f}, {"quality", 2.0f}}},
+    {"rms", {{"detector", 2.0f}, {"autorelease", 1.0f}}},
+    {"multiband", {{"multiband", 1.0f}, {"lowthreshold", -40.0f}}},
+};
+
+void applyMode(EaPureCompressorAudioProcessor &processor, const Mode &mode) {
+  for (auto *param : processor.getParameters())
+    if (auto *ranged = dynamic_cast<juce::RangedAudioParameter *>(param)) {
+      auto value = ranged->getDefaultValue();
+      for (auto &v : mode.values)
+        if (ranged->paramID == v.first)
+          value = ranged->convertTo0to1(v.second);
+      ranged->setValueNotifyingHost(value);
+    }
+}
+
+// Blocks of up to blockSize samples, which may be more than the processor
+// was prepared for
+template <typename SampleType>
+int runPass(EaPureCompressorAudioProcessor &processor, int blockSize,
+            int numBlocks, juce::Random &random) {
+  auto numChannels = juce::jmax(processor.getTotalNumInputChannels(),
+                                processor.getTotalNumOutputChannels());
+  juce::AudioBuffer<SampleType> buffer(numChannels, blockSize);
+  juce::MidiBuffer midi;
+  midi.ensureSize(256);
+
+  auto before = numAllocations.load();
+  for (int block = 0; block < numBlocks; ++block) {
+    // Full blocks mostly, sometimes shorter ones
+    auto n =
+        random.nextInt(4) == 0 ? 1 + random.nextInt(blockSize) : blockSize;
+    juce::AudioBuffer<SampleType> view(buffer.getArrayOfWritePointers(),
+                                       numChannels, n);
+    for (int ch = 0; ch < numChannels; ++ch) {
+      auto *data = view.getWritePointer(ch);
+      for (int i = 0; i < n; ++i)
+        data[i] = (SampleType)(random.nextFloat() * 2.0f - 1.0f);
+    }
+
+    counting = true;
+    processor.processBlock(view, midi);
+    counting = false;
+  }
+  return numAllocations.load() - before;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  juce::ScopedJuceInitialiser_GUI juceInit;
+
+  int numBlocks = 200;
+  for (int i = 1; i < argc; ++i) {
+    juce::String arg(argv[i]);
+    if (arg.startsWith("--blocks=")) {
+      numBlocks = juce::jmax(1, arg.fromFirstOccurrenceOf("=", false, false)
+                                    .getIntValue());
+    } else {
+      std::cerr << "usage: EA_PURE_COMPRESSOR_AllocationCheck [--blocks=<n>]"
+                << std::endl;
+      return 1;
+    }
+  }
+
+  const double sampleRates[] = {44100.0, 48000.0, 96000.0};
+  const int maxBlockSizes[] = {32, 512, 2048};
+
+  juce::Random random(1);
+  int failures = 0;
+
+  for (auto &mode : modes)
+    for (auto sampleRate : sampleRates)
+      for (auto maxBlockSize : maxBlockSizes)
+        for (auto isDouble : {false, true}) {
+          EaPureCompressorAudioProcessor processor;
+          applyMode(processor, mode);
+          processor.setProcessingPrecision(
+              isDouble ? juce::AudioProcessor::doublePrecision
+                       : juce::AudioProcessor::singlePrecision);
+          processor.setRateAndBufferSizeDetails(sampleRate, maxBlockSize);
+          processor.prepareToPlay(sampleRate, maxBlockSize);
+
+          // Some hosts send more than they announced in prepareToPlay()
+          for (auto factor : {1, 2, 4}) {
+            auto blockSize = factor * maxBlockSize;
+            auto allocations =
+                isDouble
+                    ? runPass<double>(processor, blockSize, numBlocks, random)
+                    : runPass<float>(processor, blockSize, numBlocks, random);
+
+            if (allocations > 0) {
+              ++failures;
+              std::cout << "FAIL " << mode.name << " " << sampleRate
+                        << " Hz, " << blockSize << "/" << maxBlockSize
+                        << " samples, " << (isDouble ? "double" : "float")
+                        << ": " << allocations << " allocations"
+                        << std::endl;
+            }
+          }
+          processor.releaseResources();
+        }
+
+  std::cout << (failures == 0 ? "OK" : "FAILED") << ": " << failures
+            << " passes allocated in processBlock()" << std::endl;
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,79 @@
+#include "AllocationHooks.h"
+
+#if JUCE_LINUX
+
+#include <cerrno>
+
+extern "C" {
+void *__libc_malloc(size_t);
+void *__libc_calloc(size_t, size_t);
+void *__libc_realloc(void *, size_t);
+void *__libc_memalign(size_t, size_t);
+void __libc_free(void *);
+
+void *malloc(size_t size) noexcept {
+  onAllocation("malloc");
+  return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size) noexcept {
+  onAllocation("calloc");
+  return __libc_calloc(count, size);
+}
+
+void *realloc(void *ptr, size_t size) noexcept {
+  onAllocation("realloc");
+  return __libc_realloc(ptr, size);
+}
+
+void *aligned_alloc(size_t alignment, size_t size) noexcept {
+  onAllocation("aligned_alloc");
+  return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void **ptr, size_t alignment, size_t size) noexcept {
+  onAllocation("posix_memalign");
+  *ptr = __libc_memalign(alignment, size);
+  return *ptr != nullptr ? 0 : ENOMEM;
+}
+
+void free(void *ptr) noexcept {
+  if (ptr != nullptr)
+    onAllocation("free");
+  __libc_free(ptr);
+}
+}
+
+#else
+
+// Without symbol interposition only C++ allocation is visible
+void *operator new(size_t size) {
+  onAllocation("operator new");
+  if (auto *ptr = std::malloc(size != 0 ? size : 1))
+    return ptr;
+  throw std::bad_alloc();
+}
+
+void *operator new[](size_t size) {
+  onAllocation("operator new[]");
+  if (auto *ptr = std::malloc(size != 0 ? size : 1))
+    return ptr;
+  throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept {
+  if (ptr != nullptr)
+    onAllocation("operator delete");
+  std::free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept {
+  if (ptr != nullptr)
+    onAllocation("operator delete[]");
+  std::free(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept { operator delete(ptr); }
+void operator delete[](void *ptr, size_t) noexcept { operator delete[](ptr); }
+
+#endif
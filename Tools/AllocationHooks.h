@@ -0,0 +1,12 @@
+#pragma once
+#include <JuceHeader.h>
+
+// Allocator interposers shared by the real-time tools.
+//
+// Tools/AllocationHooks.cpp replaces the allocator for the whole executable
+// and calls onAllocation() for every allocation and free, on any thread.
+// Each tool that links it defines onAllocation(); it must not allocate.
+//
+// On Linux (glibc) malloc and friends are replaced, which also catches
+// JUCE's HeapBlock. Elsewhere only the global operator new/delete are.
+void onAllocation(const char *what) noexcept;
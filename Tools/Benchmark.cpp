@@ -0,0 +1,640 @@
+// DSP micro-benchmarks.
+//
+// Times each DSP module and the full processBlock over a sweep of block
+// sizes, channel counts, sample rates and parameter settings, in both float
+// and double precision, and writes the results as JSON so runs can be
+// diffed across commits.
+//
+//   EA_PURE_COMPRESSOR_Benchmark [--out=<file.json>] [--quick]
+//                                [--filter=<module>] [--seconds=<s>]
+//                                [--precision=float|double] [--label=<text>]
+//
+// Each case processes <seconds> of audio (default 1) in host-sized blocks.
+// Only the process call itself is timed; refilling the input is not.
+//   nsPerSample:    wall time per sample frame (all channels)
+//   realtimeFactor: seconds of audio processed per second of wall time
+//   maxDifference:  ProcessingChain/fused only, largest output difference
+//                   from the staged chain (expected to be 0)
+//   maxDifferenceHighPass, maxDifferenceBandPass: Biquad/lanes only, largest
+//                   difference of the saturation high-pass and the
+//                   CoreProtect band-pass from juce::dsp::IIR::Filter
+//
+// Exits 1 if the Biquad filters drift from juce::dsp::IIR::Filter by more
+// than rounding.
+//
+// The "state" module times getStateInformation/setStateInformation (binary
+// and the legacy XML format) and factory program switches instead, as
+// usPerCall, with the blob size in bytes.
+
+#include "PluginProcessor.h"
+#include <JuceHeader.h>
+#include <iostream>
+
+namespace {
+
+struct ParameterSet {
+  const char *name;
+  float threshold, ratio, attack, release, gain;
+};
+
+const ParameterSet parameterSets[] = {
+    {"default", -10.0f, 2.0f, 10.0f, 100.0f, 0.0f},
+    {"heavy", -60.0f, 20.0f, 0.1f, 10.0f, 24.0f},
+    {"light", 0.0f, 1.0f, 100.0f, 1000.0f, 0.0f},
+};
+
+struct Case {
+  juce::String module;
+  juce::String variant;
+  juce::String precision;
+  int blockSize = 512;
+  int numChannels = 2;
+  double sampleRate = 48000.0;
+  const ParameterSet *params = nullptr;
+};
+
+class Benchmark {
+public:
+  explicit Benchmark(double secondsPerCase) : seconds(secondsPerCase) {}
+
+  // prepare() is called once per case, process() once per block. Only the
+  // process() calls are timed. Returns the case's result entry so callers
+  // can attach extra fields.
+  template <typename SampleType>
+  juce::DynamicObject &
+  run(const Case &c, const std::function<void()> &prepare,
+      const std::function<void(juce::AudioBuffer<SampleType> &)> &process) {
+    prepare();
+
+    auto totalSamples = (int)(seconds * c.sampleRate);
+    fillSource(c.numChannels, c.sampleRate);
+
+    juce::AudioBuffer<SampleType> block(c.numChannels, c.blockSize);
+
+    // One untimed pass to warm caches and settle the envelopes
+    runBlocks(c, block, process, juce::jmin(totalSamples, 8192));
+    auto ticks = runBlocks(c, block, process, totalSamples);
+
+    auto wallSeconds = juce::Time::highResolutionTicksToSeconds(ticks);
+    auto *result = new juce::DynamicObject();
+    result->setProperty("module", c.module);
+    result->setProperty("variant", c.variant);
+    result->setProperty("precision", c.precision);
+    result->setProperty("blockSize", c.blockSize);
+    result->setProperty("channels", c.numChannels);
+    result->setProperty("sampleRate", c.sampleRate);
+    result->setProperty("params", juce::String(c.params->name));
+    result->setProperty("nsPerSample", wallSeconds * 1.0e9 / totalSamples);
+    result->setProperty("realtimeFactor",
+                        wallSeconds > 0.0
+                            ? (totalSamples / c.sampleRate) / wallSeconds
+                            : 0.0);
+    results.add(juce::var(result));
+
+    std::cerr << c.module << c.variant << " " << c.precision
+              << " bs=" << c.blockSize
+              << " ch=" << c.numChannels << " sr=" << c.sampleRate << " "
+              << c.params->name << ": " << wallSeconds * 1.0e9 / totalSamples
+              << " ns/sample" << std::endl;
+    return *result;
+  }
+
+  // Counts a failure if a result drifted further than tolerance from its
+  // reference
+  void checkDifference(const Case &c, const char *what, double maxDifference,
+                       double tolerance) {
+    if (maxDifference > tolerance) {
+      ++failures;
+      std::cerr << "FAIL " << c.module << c.variant << " " << what << " "
+                << c.precision << " bs=" << c.blockSize
+                << " ch=" << c.numChannels << " sr=" << c.sampleRate
+                << ": max difference " << maxDifference << " > "
+                << tolerance << std::endl;
+    }
+  }
+
+  juce::Array<juce::var> results;
+  int failures = 0;
+
+private:
+  template <typename SampleType>
+  juce::int64 runBlocks(
+      const Case &c, juce::AudioBuffer<SampleType> &block,
+      const std::function<void(juce::AudioBuffer<SampleType> &)> &process,
+      int totalSamples) {
+    juce::int64 ticks = 0;
+
+    for (int pos = 0; pos < totalSamples; pos += c.blockSize) {
+      auto numSamples = juce::jmin(c.blockSize, totalSamples - pos);
+      auto sourcePos = pos % (source.getNumSamples() - c.blockSize);
+
+      juce::AudioBuffer<SampleType> view(block.getArrayOfWritePointers(),
+                                         c.numChannels, numSamples);
+      for (int ch = 0; ch < c.numChannels; ++ch) {
+        const auto *src = source.getReadPointer(ch, sourcePos);
+        auto *dest = view.getWritePointer(ch);
+        for (int i = 0; i < numSamples; ++i)
+          dest[i] = (SampleType)src[i];
+      }
+
+      auto start = juce::Time::getHighResolutionTicks();
+      process(view);
+      ticks += juce::Time::getHighResolutionTicks() - start;
+    }
+
+    return ticks;
+  }
+
+  // Two seconds of level-modulated noise with a 2 Hz envelope, so the
+  // compressor moves through attack and release continuously
+  void fillSource(int numChannels, double sampleRate) {
+    auto length = (int)(2.0 * sampleRate) + 4096;
+    source.setSize(numChannels, length);
+
+    juce::Random random(1234);
+    for (int ch = 0; ch < numChannels; ++ch) {
+      auto *data = source.getWritePointer(ch);
+      for (int i = 0; i < length; ++i) {
+        auto env = 0.5f + 0.45f * std::sin(juce::MathConstants<float>::twoPi *
+                                           2.0f * (float)(i / sampleRate));
+        data[i] = env * (random.nextFloat() * 2.0f - 1.0f);
+      }
+    }
+  }
+
+  double seconds;
+  juce::AudioBuffer<float> source;
+};
+
+void setParameters(EaPureCompressorAudioProcessor &processor,
+                   const ParameterSet &p) {
+  auto set = [&](const char *id, float value) {
+    auto *param = processor.apvts.getParameter(id);
+    param->setValueNotifyingHost(param->convertTo0to1(value));
+  };
+
+  set("threshold", p.threshold);
+  set("ratio", p.ratio);
+  set("attack", p.attack);
+  set("release", p.release);
+  set("gain", p.gain);
+}
+
+// Largest sample difference between the staged and fused chains over one
+// second of noise. Every stage streams, so this should be exactly zero.
+template <typename SampleType>
+double compareStagedAndFused(const Case &c, const ChainParameters &params) {
+  ProcessingChain<SampleType> staged, fused;
+  staged.prepare(c.sampleRate, c.blockSize, c.numChannels);
+  fused.prepare(c.sampleRate, c.blockSize, c.numChannels);
+
+  juce::AudioBuffer<SampleType> a(c.numChannels, c.blockSize);
+  juce::AudioBuffer<SampleType> b(c.numChannels, c.blockSize);
+  juce::Random random(42);
+  double maxDifference = 0.0;
+
+  for (int pos = 0; pos < (int)c.sampleRate; pos += c.blockSize) {
+    for (int ch = 0; ch < c.numChannels; ++ch)
+      for (int i = 0; i < c.blockSize; ++i)
+        a.setSample(ch, i, (SampleType)(random.nextFloat() - 0.5f));
+    b.makeCopyOf(a, true);
+
+    staged.process(a, params, nullptr, c.blockSize);
+    fused.process(b, params);
+
+    for (int ch = 0; ch < c.numChannels; ++ch)
+      for (int i = 0; i < c.blockSize; ++i)
+        maxDifference =
+            std::max(maxDifference, (double)std::abs(a.getSample(ch, i) -
+                                                     b.getSample(ch, i)));
+  }
+
+  return maxDifference;
+}
+
+// Largest sample difference between BiquadFilter and one
+// juce::dsp::IIR::Filter per channel, both set up for the same filter, over
+// one second of noise. Same formulas and arithmetic, so only rounding.
+template <typename SampleType>
+double compareBiquadAndJuceIIR(
+    const Case &c,
+    const typename BiquadFilter<SampleType>::Coefficients &coefficients,
+    typename juce::dsp::IIR::Coefficients<SampleType>::Ptr juceCoefficients) {
+  BiquadFilter<SampleType> biquad;
+  biquad.prepare(c.numChannels, c.blockSize);
+  biquad.setCoefficients(coefficients);
+
+  std::vector<juce::dsp::IIR::Filter<SampleType>> filters(
+      (size_t)c.numChannels);
+  for (auto &filter : filters) {
+    filter.coefficients = juceCoefficients;
+    filter.reset();
+  }
+
+  juce::AudioBuffer<SampleType> a(c.numChannels, c.blockSize);
+  juce::AudioBuffer<SampleType> b(c.numChannels, c.blockSize);
+  juce::Random random(42);
+  double maxDifference = 0.0;
+
+  for (int pos = 0; pos < (int)c.sampleRate; pos += c.blockSize) {
+    for (int ch = 0; ch < c.numChannels; ++ch)
+      for (int i = 0; i < c.blockSize; ++i)
+        a.setSample(ch, i, (SampleType)(random.nextFloat() - 0.5f));
+    b.makeCopyOf(a, true);
+
+    biquad.process(a.getArrayOfWritePointers(), c.numChannels, c.blockSize);
+    for (int ch = 0; ch < c.numChannels; ++ch) {
+      auto *data = b.getWritePointer(ch);
+      for (int i = 0; i < c.blockSize; ++i)
+        data[i] = filters[(size_t)ch].processSample(data[i]);
+      filters[(size_t)ch].snapToZero();
+    }
+
+    for (int ch = 0; ch < c.numChannels; ++ch)
+      for (int i = 0; i < c.blockSize; ++i)
+        maxDifference =
+            std::max(maxDifference, (double)std::abs(a.getSample(ch, i) -
+                                                     b.getSample(ch, i)));
+  }
+
+  return maxDifference;
+}
+
+template <typename SampleType>
+void runModules(Benchmark &bench, Case c, const juce::String &filter) {
+  using Buffer = juce::AudioBuffer<SampleType>;
+  const auto &p = *c.params;
+  c.precision = std::is_same_v<SampleType, double> ? "double" : "float";
+
+  auto wanted = [&](const char *module) {
+    return filter.isEmpty() || juce::String(module).contains(filter);
+  };
+
+  if (wanted("CompressorEngine")) {
+    // Lookahead off, short and at the maximum window; the sliding max should
+    // keep the cost flat across window lengths
+    using Engine = CompressorEngine<SampleType>;
+    const float lookaheads[] = {0.0f, 1.0f, Engine::maxLookaheadMs};
+    const char *names[] = {"", "/lookahead1ms", "/lookahead10ms"};
+    for (int i = 0; i < 3; ++i) {
+      Engine engine;
+      c.module = "CompressorEngine";
+      c.variant = names[i];
+      bench.run<SampleType>(
+          c,
+          [&] {
+            engine.prepare(c.sampleRate, c.blockSize, c.numChannels);
+            engine.setLookahead(lookaheads[i]);
+          },
+          [&](Buffer &buffer) {
+            engine.process(buffer, p.threshold, p.ratio, p.attack, p.release);
+          });
+    }
+
+    // RMS over a short and the longest window (the running sum should keep
+    // these level), and the blended detector with the dual release
+    const float windows[] = {1.0f, Engine::maxRmsWindowMs, 10.0f};
+    const float mixes[] = {1.0f, 1.0f, 0.5f};
+    const char *detectorNames[] = {"/rms1ms", "/rms50ms",
+                                   "/blend+autorelease"};
+    for (int i = 0; i < 3; ++i) {
+      Engine engine;
+      c.module = "CompressorEngine";
+      c.variant = detectorNames[i];
+      bench.run<SampleType>(
+          c,
+          [&] {
+            engine.prepare(c.sampleRate, c.blockSize, c.numChannels);
+            engine.setDetector(mixes[i], windows[i]);
+            engine.setProgramRelease(i == 2);
+          },
+          [&](Buffer &buffer) {
+            engine.process(buffer, p.threshold, p.ratio, p.attack, p.release);
+          });
+    }
+    c.variant = {};
+  }
+
+  if (wanted("MultibandCompressor")) {
+    // Crossovers plus three engines in lock-step; compare with
+    // CompressorEngine above, the goal is well under three times its cost
+    MultibandCompressor<SampleType> multiband;
+    typename MultibandCompressor<SampleType>::Bands bands;
+    for (auto &band : bands) {
+      band.threshold = p.threshold;
+      band.ratio = p.ratio;
+    }
+    c.module = "MultibandCompressor";
+    bench.run<SampleType>(
+        c,
+        [&] { multiband.prepare(c.sampleRate, c.blockSize, c.numChannels); },
+        [&](Buffer &buffer) {
+          multiband.process(buffer, bands, p.attack, p.release);
+        });
+  }
+
+  if (wanted("CoreProtect")) {
+    CoreProtect<SampleType> coreProtect;
+    c.module = "CoreProtect";
+    bench.run<SampleType>(
+        c,
+        [&] { coreProtect.prepare(c.sampleRate, c.blockSize, c.numChannels); },
+        [&](Buffer &buffer) {
+          juce::ignoreUnused(coreProtect.process(buffer, p.ratio));
+        });
+  }
+
+  if (wanted("Biquad")) {
+    // The saturation high-pass through the lane-parallel BiquadFilter vs.
+    // the juce::dsp::IIR::Filter per channel it replaced
+    using Biquad = BiquadFilter<SampleType>;
+    using IIR = juce::dsp::IIR::Filter<SampleType>;
+    using IIRCoefficients = juce::dsp::IIR::Coefficients<SampleType>;
+
+    // Anything beyond accumulated rounding is a real difference
+    const auto tolerance = std::is_same_v<SampleType, double> ? 1.0e-10
+                                                              : 1.0e-4;
+
+    Biquad biquad;
+    c.module = "Biquad";
+    c.variant = "/lanes";
+    auto &result = bench.run<SampleType>(
+        c,
+        [&] {
+          biquad.prepare(c.numChannels, c.blockSize);
+          biquad.setCoefficients(Biquad::Coefficients::makeHighPass(
+              c.sampleRate, SampleType(15000)));
+        },
+        [&](Buffer &buffer) {
+          biquad.process(buffer.getArrayOfWritePointers(),
+                         buffer.getNumChannels(), buffer.getNumSamples());
+        });
+
+    // The CoreProtect band-pass costs the same per sample, so it is only
+    // checked, not timed
+    auto highPassDifference = compareBiquadAndJuceIIR<SampleType>(
+        c, Biquad::Coefficients::makeHighPass(c.sampleRate, SampleType(15000)),
+        IIRCoefficients::makeHighPass(c.sampleRate, SampleType(15000)));
+    auto bandPassDifference = compareBiquadAndJuceIIR<SampleType>(
+        c,
+        Biquad::Coefficients::makeBandPass(c.sampleRate, SampleType(1000),
+                                           SampleType(1.5)),
+        IIRCoefficients::makeBandPass(c.sampleRate, SampleType(1000),
+                                      SampleType(1.5)));
+    result.setProperty("maxDifferenceHighPass", highPassDifference);
+    result.setProperty("maxDifferenceBandPass", bandPassDifference);
+    bench.checkDifference(c, "high-pass", highPassDifference, tolerance);
+    bench.checkDifference(c, "band-pass", bandPassDifference, tolerance);
+
+    juce::dsp::ProcessorDuplicator<IIR, IIRCoefficients> iir;
+    c.variant = "/juceIIR";
+    bench.run<SampleType>(
+        c,
+        [&] {
+          iir.state =
+              IIRCoefficients::makeHighPass(c.sampleRate, SampleType(15000));
+          iir.prepare({c.sampleRate, (juce::uint32)c.blockSize,
+                       (juce::uint32)c.numChannels});
+        },
+        [&](Buffer &buffer) {
+          juce::dsp::AudioBlock<SampleType> block(buffer);
+          iir.process(juce::dsp::ProcessContextReplacing<SampleType>(block));
+        });
+    c.variant = {};
+  }
+
+  if (wanted("CrystallineSaturation")) {
+    // One run per oversampling setting of the high band
+    const char *qualities[] = {"/1x", "/2x", "/4x"};
+    for (int quality = 0; quality < 3; ++quality) {
+      CrystallineSaturation<SampleType> saturation;
+      c.module = "CrystallineSaturation";
+      c.variant = qualities[quality];
+      bench.run<SampleType>(
+          c,
+          [&] {
+            saturation.prepare(c.sampleRate, c.blockSize, c.numChannels);
+            saturation.setOversampling(quality);
+          },
+          [&](Buffer &buffer) {
+            saturation.process(buffer, p.gain);
+          });
+    }
+    c.variant = {};
+  }
+
+  if (wanted("ProcessingChain")) {
+    // The whole block through each stage in turn vs. cache-sized tiles
+    // through all stages; the gap grows with the block size
+    ChainParameters params{p.threshold, p.ratio, p.attack, p.release, p.gain};
+    const int tileSizes[] = {
+        c.blockSize, ProcessingChain<SampleType>::defaultTileSize};
+    const char *names[] = {"/staged", "/fused"};
+    for (int i = 0; i < 2; ++i) {
+      ProcessingChain<SampleType> chain;
+      c.module = "ProcessingChain";
+      c.variant = names[i];
+      auto &result = bench.run<SampleType>(
+          c,
+          [&] { chain.prepare(c.sampleRate, c.blockSize, c.numChannels); },
+          [&](Buffer &buffer) {
+            chain.process(buffer, params, nullptr, tileSizes[i]);
+          });
+
+      if (i == 1)
+        result.setProperty("maxDifference",
+                           compareStagedAndFused<SampleType>(c, params));
+    }
+    c.variant = {};
+  }
+
+  if (wanted("processBlock")) {
+    EaPureCompressorAudioProcessor processor;
+    juce::MidiBuffer midi;
+    c.module = "processBlock";
+    bench.run<SampleType>(
+        c,
+        [&] {
+          processor.setProcessingPrecision(
+              std::is_same_v<SampleType, double>
+                  ? juce::AudioProcessor::doublePrecision
+                  : juce::AudioProcessor::singlePrecision);
+          processor.setPlayConfigDetails(c.numChannels, c.numChannels,
+                                         c.sampleRate, c.blockSize);
+          setParameters(processor, p);
+          processor.prepareToPlay(c.sampleRate, c.blockSize);
+        },
+        [&](Buffer &buffer) {
+          processor.processBlock(buffer, midi);
+        });
+  }
+}
+
+// Calls fn repeatedly for about the given time, returns microseconds per
+// call
+double timeCalls(double seconds, const std::function<void()> &fn) {
+  for (int i = 0; i < 10; ++i)
+    fn();
+
+  juce::int64 calls = 0;
+  auto start = juce::Time::getHighResolutionTicks();
+  auto end = start + juce::Time::secondsToHighResolutionTicks(seconds);
+  auto now = start;
+  do {
+    for (int i = 0; i < 16; ++i)
+      fn();
+    calls += 16;
+    now = juce::Time::getHighResolutionTicks();
+  } while (now < end);
+
+  return juce::Time::highResolutionTicksToSeconds(now - start) * 1.0e6 /
+         (double)calls;
+}
+
+void runStateBenchmarks(Benchmark &bench, double seconds) {
+  EaPureCompressorAudioProcessor processor;
+  setParameters(processor, parameterSets[1]);
+
+  juce::MemoryBlock binary, xml, scratch;
+  processor.getStateInformation(binary);
+  if (auto state = processor.apvts.copyState().createXml())
+    juce::AudioProcessor::copyXmlToBinary(*state, xml);
+
+  auto add = [&](const char *variant, size_t bytes, double usPerCall) {
+    auto *result = new juce::DynamicObject();
+    result->setProperty("module", "state");
+    result->setProperty("variant", variant);
+    result->setProperty("bytes", (int)bytes);
+    result->setProperty("usPerCall", usPerCall);
+    bench.results.add(juce::var(result));
+
+    std::cerr << "state/" << variant << " (" << bytes << " bytes): "
+              << usPerCall << " us/call" << std::endl;
+  };
+
+  add("saveBinary", binary.getSize(), timeCalls(seconds, [&] {
+        processor.getStateInformation(scratch);
+      }));
+  add("saveXml", xml.getSize(), timeCalls(seconds, [&] {
+        if (auto state = processor.apvts.copyState().createXml())
+          juce::AudioProcessor::copyXmlToBinary(*state, scratch);
+      }));
+
+  // Alternate between two states so every restore changes the parameters
+  juce::MemoryBlock defaults, defaultsXml;
+  setParameters(processor, parameterSets[0]);
+  processor.getStateInformation(defaults);
+  if (auto state = processor.apvts.copyState().createXml())
+    juce::AudioProcessor::copyXmlToBinary(*state, defaultsXml);
+
+  int restores = 0;
+  add("restoreBinary", binary.getSize(), timeCalls(seconds, [&] {
+        auto &blob = (restores++ & 1) != 0 ? defaults : binary;
+        processor.setStateInformation(blob.getData(), (int)blob.getSize());
+      }));
+  add("restoreXml", xml.getSize(), timeCalls(seconds, [&] {
+        auto &blob = (restores++ & 1) != 0 ? defaultsXml : xml;
+        processor.setStateInformation(blob.getData(), (int)blob.getSize());
+      }));
+
+  int program = 0;
+  add("programSwitch", 0, timeCalls(seconds, [&] {
+        program = (program + 1) % processor.getNumPrograms();
+        processor.setCurrentProgram(program);
+      }));
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  juce::ScopedJuceInitialiser_GUI juceInit;
+
+  juce::File outFile;
+  juce::String filter, label, precision;
+  double seconds = 1.0;
+  bool quick = false;
+
+  for (int i = 1; i < argc; ++i) {
+    juce::String arg(argv[i]);
+    auto name = arg.upToFirstOccurrenceOf("=", false, false);
+    auto value = arg.fromFirstOccurrenceOf("=", false, false);
+
+    if (name == "--out")
+      outFile = juce::File::getCurrentWorkingDirectory().getChildFile(value);
+    else if (name == "--filter")
+      filter = value;
+    else if (name == "--precision")
+      precision = value;
+    else if (name == "--label")
+      label = value;
+    else if (name == "--seconds")
+      seconds = juce::jmax(0.01, value.getDoubleValue());
+    else if (name == "--quick")
+      quick = true;
+    else {
+      std::cerr << "usage: EA_PURE_COMPRESSOR_Benchmark [--out=<file.json>] "
+                   "[--quick] [--filter=<module>] [--seconds=<s>] "
+                   "[--precision=float|double] [--label=<text>]"
+                << std::endl;
+      return 1;
+    }
+  }
+
+  juce::Array<int> blockSizes{16,   32,   64,   128,  256,
+                              512,  1024, 2048, 4096, 8192};
+  juce::Array<double> sampleRates{44100.0, 48000.0, 96000.0, 192000.0};
+  // Mono, stereo, 5.1, 7.1 and 7.1.4
+  juce::Array<int> channelCounts{1, 2, 6, 8, 12};
+
+  if (quick) {
+    blockSizes = {64, 512, 4096, 8192};
+    sampleRates = {48000.0};
+    channelCounts = {1, 2, 12};
+  }
+
+  Benchmark bench(seconds);
+
+  for (auto &params : parameterSets)
+    for (auto sampleRate : sampleRates)
+      for (auto numChannels : channelCounts)
+        for (auto blockSize : blockSizes) {
+          Case c;
+          c.blockSize = blockSize;
+          c.numChannels = numChannels;
+          c.sampleRate = sampleRate;
+          c.params = &params;
+          if (precision.isEmpty() || precision == "float")
+            runModules<float>(bench, c, filter);
+          if (precision.isEmpty() || precision == "double")
+            runModules<double>(bench, c, filter);
+        }
+
+  if (filter.isEmpty() || juce::String("state").contains(filter))
+    runStateBenchmarks(bench, seconds);
+
+  auto *report = new juce::DynamicObject();
+  report->setProperty("label", label);
+  report->setProperty("date", juce::Time::getCurrentTime().toISO8601(true));
+  report->setProperty("fastMath", EA_PURE_COMPRESSOR_FAST_MATH != 0);
+#if JUCE_DEBUG
+  report->setProperty("debugBuild", true);
+#else
+  report->setProperty("debugBuild", false);
+#endif
+  report->setProperty("results", bench.results);
+
+  auto json = juce::JSON::toString(juce::var(report));
+
+  if (outFile == juce::File()) {
+    std::cout << json << std::endl;
+  } else if (!outFile.replaceWithText(json)) {
+    std::cerr << "Cannot write " << outFile.getFullPathName() << std::endl;
+    return 1;
+  }
+
+  if (bench.failures > 0) {
+    std::cerr << bench.failures << " accuracy checks failed" << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,136 @@
+// Error bounds of the FastMath kernels.
+//
+// Sweeps the fast log2/exp2 kernels against std::log2/std::exp2 and checks
+// the bounds documented in FastMath.h:
+//   fastLog2: absolute error over positive normal floats
+//   fastExp2: relative error over [-126, 126]
+//   gain computer: applied gain over the full threshold (-60..0 dB) and
+//                  ratio (1..20) range, levels from -120 to +24 dB, for
+//                  the float path and the exact double path
+// Exits 1 if any bound is exceeded, so run it after touching the kernels.
+//
+//   EA_PURE_COMPRESSOR_FastMathCheck
+
+#include "DSP/FastMath.h"
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+constexpr double maxLog2Error = 6.3e-5; // log2 units
+constexpr double maxExp2Error = 3.7e-6; // relative
+constexpr double maxGainErrorDB = 0.0004;
+// Exact log2/exp2; what's left is the threshold conversion, done in float
+// on the parameter value
+constexpr double maxDoubleGainErrorDB = 1e-5;
+
+struct Result {
+  const char *name;
+  double worst, bound;
+  float worstInput;
+};
+
+bool report(const Result &r) {
+  auto ok = r.worst <= r.bound;
+  std::printf("%-22s max error %.3g (bound %.3g) at %.9g: %s\n", r.name,
+              r.worst, r.bound, (double)r.worstInput, ok ? "ok" : "FAIL");
+  return ok;
+}
+
+template <typename Float, typename Fast>
+Result checkLog2(const char *name, Fast fast) {
+  Result r{name, 0.0, maxLog2Error, 0.0f};
+
+  // Every 16th float from the smallest normal up to 2^64
+  for (std::uint32_t bits = 0x00800000u; bits < 0x5f800000u; bits += 16) {
+    float x;
+    std::memcpy(&x, &bits, sizeof(x));
+    auto error = std::abs((double)fast((Float)x) - std::log2((double)x));
+    if (error > r.worst) {
+      r.worst = error;
+      r.worstInput = x;
+    }
+  }
+  return r;
+}
+
+template <typename Float, typename Fast>
+Result checkExp2(const char *name, Fast fast) {
+  Result r{name, 0.0, maxExp2Error, 0.0f};
+
+  for (int i = -126 * 65536; i <= 126 * 65536; ++i) {
+    auto x = (float)i / 65536.0f;
+    auto exact = std::exp2((double)x);
+    auto error = std::abs((double)fast((Float)x) - exact) / exact;
+    if (error > r.worst) {
+      r.worst = error;
+      r.worstInput = x;
+    }
+  }
+  return r;
+}
+
+// Same arithmetic as CompressorEngine::computeGain, against exact dB
+template <typename Float>
+Result checkGainComputer(const char *name, double bound) {
+  Result r{name, 0.0, bound, 0.0f};
+  const auto maxReduction = (Float)FastMath::maxReductionLog2;
+
+  // Levels in 0.1 dB steps, and their fast log2
+  constexpr int numLevels = 1441;
+  std::vector<double> levelsDB(numLevels);
+  std::vector<Float> levelsLog2(numLevels);
+  for (int l = 0; l < numLevels; ++l) {
+    levelsDB[(size_t)l] = -120.0 + 0.1 * l;
+    auto level = (Float)std::pow(10.0, levelsDB[(size_t)l] / 20.0);
+    levelsDB[(size_t)l] = 20.0 * std::log10((double)level);
+    levelsLog2[(size_t)l] = FastMath::log2(level);
+  }
+
+  for (int t = 0; t <= 600; ++t) {
+    auto thresholdDB = -60.0f + 0.1f * (float)t;
+    auto threshold = (Float)(thresholdDB / FastMath::decibelsPerLog2);
+
+    for (int q = 10; q <= 200; ++q) {
+      auto ratio = 0.1f * (float)q;
+      auto slope = Float(1) - Float(1) / (Float)ratio;
+
+      for (int l = 0; l < numLevels; ++l) {
+        auto levelDB = levelsDB[(size_t)l];
+        auto reduction = std::min(
+            std::max(Float(0), levelsLog2[(size_t)l] - threshold) * slope,
+            maxReduction);
+        auto gain = FastMath::exp2(-reduction);
+        auto gainDB = 20.0 * std::log10((double)gain);
+
+        auto exactDB = -std::max(0.0, levelDB - (double)thresholdDB) *
+                       (1.0 - 1.0 / (double)ratio);
+
+        auto error = std::abs(gainDB - exactDB);
+        if (error > r.worst) {
+          r.worst = error;
+          r.worstInput = (float)levelDB;
+        }
+      }
+    }
+  }
+  return r;
+}
+
+} // namespace
+
+int main() {
+  auto fastLog2 = [](float x) { return FastMath::fastLog2(x); };
+  auto fastExp2 = [](float x) { return FastMath::fastExp2(x); };
+
+  bool ok = true;
+  ok &= report(checkLog2<float>("fastLog2 (float)", fastLog2));
+  ok &= report(checkExp2<float>("fastExp2 (float)", fastExp2));
+  ok &= report(
+      checkGainComputer<float>("gain computer (float)", maxGainErrorDB));
+  ok &= report(checkGainComputer<double>("gain computer (double)",
+                                         maxDoubleGainErrorDB));
+
+  std::printf(ok ? "OK\n" : "FAILED\n");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,96 @@
+// Golden references from the pre-optimization engine.
+//
+// Built from the DSP sources of a pinned commit
+// (EA_PURE_COMPRESSOR_GOLDEN_BASELINE, the initial import by default), which
+// CMake extracts from git at configure time. None of this tree's DSP code
+// goes into it, so a change to code the optimized build and
+// EA_PURE_COMPRESSOR_GoldenReference share still shows up against these
+// references.
+//
+//   EA_PURE_COMPRESSOR_GoldenBaseline --generate=<dir>
+//
+// Writes the cases GoldenCases.h marks as baseline cases: the compressor
+// with fixed settings, per-sample and exact, as the engine was before any
+// of the optimizations. Then run EA_PURE_COMPRESSOR_GoldenReference
+// --generate and EA_PURE_COMPRESSOR_Golden --check on the same directory.
+//
+// The pinned commit has to provide the baseline's CompressorEngine
+// interface: prepare(sampleRate, blockSize) and a float process().
+
+#include "DSP/CompressorEngine.h"
+#include "GoldenCases.h"
+#include <JuceHeader.h>
+#include <iostream>
+
+namespace {
+
+using namespace golden;
+
+juce::AudioBuffer<float> renderCompressor(const Signal &signal,
+                                          const juce::AudioBuffer<float> &input,
+                                          double sampleRate, int blockSize) {
+  auto numSamples = input.getNumSamples();
+  juce::AudioBuffer<float> audio;
+  audio.makeCopyOf(input);
+
+  CompressorEngine engine;
+  engine.prepare(sampleRate, blockSize);
+
+  for (int start = 0; start < numSamples; start += blockSize) {
+    auto n = juce::jmin(blockSize, numSamples - start);
+    auto p = settingsAt(signal, (double)start / numSamples);
+    juce::AudioBuffer<float> block(audio.getArrayOfWritePointers(),
+                                   numChannels, start, n);
+    engine.process(block, p.threshold, p.ratio, p.attack, p.release);
+  }
+
+  return audio;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  juce::ScopedJuceInitialiser_GUI juceInit;
+
+  juce::String arg(argc == 2 ? argv[1] : "");
+  if (!arg.startsWith("--generate=")) {
+    std::cerr << "usage: EA_PURE_COMPRESSOR_GoldenBaseline --generate=<dir>"
+              << std::endl;
+    return 1;
+  }
+
+  auto directory = juce::File::getCurrentWorkingDirectory().getChildFile(
+      arg.fromFirstOccurrenceOf("=", false, false));
+  if (!directory.createDirectory()) {
+    std::cerr << "Cannot create " << directory.getFullPathName() << std::endl;
+    return 1;
+  }
+
+  int numCases = 0;
+
+  for (auto &signal : signals)
+    for (auto sampleRate : sampleRates)
+      for (auto blockSize : blockSizes) {
+        if (!isBaselineCase("CompressorEngine", signal))
+          continue;
+
+        juce::AudioBuffer<float> input(numChannels, (int)sampleRate);
+        input.clear();
+        signal.generate(input, sampleRate);
+
+        auto file = directory.getChildFile(
+            caseName(signal, sampleRate, blockSize, "CompressorEngine") +
+            ".wav");
+        auto reference =
+            renderCompressor(signal, input, sampleRate, blockSize);
+        if (!writeReference(file, reference, sampleRate)) {
+          std::cerr << "Cannot write " << file.getFullPathName() << std::endl;
+          return 1;
+        }
+        ++numCases;
+      }
+
+  std::cout << "Wrote " << numCases << " baseline references to "
+            << directory.getFullPathName() << std::endl;
+  return 0;
+}
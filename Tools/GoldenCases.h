@@ -0,0 +1,186 @@
+#pragma once
+#include <JuceHeader.h>
+
+// Cases shared by the golden-render tools: the test signals, their
+// settings, the case names and the reference files. GoldenRender.cpp renders
+// them through this tree's DSP, GoldenBaseline.cpp through the pinned
+// pre-optimization engine, so nothing here may depend on Source/DSP.
+namespace golden {
+
+inline constexpr double sampleRates[] = {44100.0, 96000.0};
+inline constexpr int blockSizes[] = {64, 2048};
+inline constexpr int numChannels = 2;
+
+//==============================================================================
+// Test signals
+
+using SignalGenerator = void (*)(juce::AudioBuffer<float> &, double);
+
+inline void makeSine(juce::AudioBuffer<float> &buffer, double sampleRate) {
+  for (int i = 0; i < buffer.getNumSamples(); ++i) {
+    auto x = (float)std::sin(juce::MathConstants<double>::twoPi * 997.0 * i /
+                             sampleRate);
+    buffer.setSample(0, i, 0.5f * x);  // -6 dBFS
+    buffer.setSample(1, i, 0.25f * x); // -12 dBFS
+  }
+}
+
+// 40 ms at 0 dBFS, 160 ms at -40 dBFS: exercises attack and release
+inline void makeBursts(juce::AudioBuffer<float> &buffer, double sampleRate) {
+  auto period = (int)(0.2 * sampleRate);
+  auto burst = (int)(0.04 * sampleRate);
+  for (int i = 0; i < buffer.getNumSamples(); ++i) {
+    auto level = (i % period) < burst ? 1.0f : 0.01f;
+    auto x = (float)std::sin(juce::MathConstants<double>::twoPi * 1000.0 * i /
+                             sampleRate);
+    for (int ch = 0; ch < numChannels; ++ch)
+      buffer.setSample(ch, i, level * x);
+  }
+}
+
+inline void makeNoise(juce::AudioBuffer<float> &buffer, double sampleRate) {
+  juce::Random random(1234);
+  for (int i = 0; i < buffer.getNumSamples(); ++i) {
+    auto env = 0.5f + 0.45f * (float)std::sin(
+                                  juce::MathConstants<double>::twoPi * 2.0 *
+                                  i / sampleRate);
+    for (int ch = 0; ch < numChannels; ++ch)
+      buffer.setSample(ch, i, 0.5f * env * (random.nextFloat() * 2.0f - 1.0f));
+  }
+}
+
+// Kick on every beat, snare on 2 and 4, hats on eighths at 120 BPM
+inline void makeDrums(juce::AudioBuffer<float> &buffer, double sampleRate) {
+  juce::Random random(99);
+  auto beat = (int)(0.5 * sampleRate);
+  auto eighth = beat / 2;
+  double kickPhase = 0.0;
+  float hatPrevious = 0.0f;
+
+  for (int i = 0; i < buffer.getNumSamples(); ++i) {
+    auto tBeat = (double)(i % beat) / sampleRate;
+    auto tEighth = (double)(i % eighth) / sampleRate;
+    auto beatIndex = i / beat;
+
+    // Pitch-swept sine
+    auto kickFreq = 45.0 + 105.0 * std::exp(-tBeat / 0.04);
+    if (i % beat == 0)
+      kickPhase = 0.0;
+    else
+      kickPhase += juce::MathConstants<double>::twoPi * kickFreq / sampleRate;
+    auto kick = 0.9 * std::exp(-tBeat / 0.25) * std::sin(kickPhase);
+
+    // Noise plus a body tone
+    auto snare = 0.0;
+    if (beatIndex % 2 == 1)
+      snare = std::exp(-tBeat / 0.12) *
+              (0.5 * (random.nextDouble() * 2.0 - 1.0) +
+               0.3 * std::sin(juce::MathConstants<double>::twoPi * 180.0 *
+                              tBeat));
+
+    // Differentiated noise, roughly high-passed
+    auto white = random.nextFloat() * 2.0f - 1.0f;
+    auto hat = 0.25 * std::exp(-tEighth / 0.03) * (white - hatPrevious);
+    hatPrevious = white;
+
+    buffer.setSample(0, i, (float)(kick + snare + 0.7 * hat));
+    buffer.setSample(1, i, (float)(kick + 0.8 * snare + hat));
+  }
+}
+
+// Pink-ish noise at about -12 dBFS; the parameters sweep (see paramsAt)
+inline void makeSweep(juce::AudioBuffer<float> &buffer, double) {
+  juce::Random random(7);
+  float state[numChannels] = {};
+  for (int i = 0; i < buffer.getNumSamples(); ++i)
+    for (int ch = 0; ch < numChannels; ++ch) {
+      state[ch] = 0.97f * state[ch] +
+                  0.03f * (random.nextFloat() * 2.0f - 1.0f) * 8.0f;
+      buffer.setSample(ch, i, 0.25f * state[ch]);
+    }
+}
+
+struct Signal {
+  const char *name;
+  SignalGenerator generate;
+  bool sweepParameters;
+};
+
+inline const Signal signals[] = {
+    {"sine", makeSine, false},     {"bursts", makeBursts, false},
+    {"noise", makeNoise, false},   {"drums", makeDrums, false},
+    {"sweep", makeSweep, true},
+};
+
+// Settings for the compressor and the chain. Plain values, so the baseline
+// generator needs nothing from this tree's DSP headers.
+struct Settings {
+  float threshold, ratio, attack, release, gain;
+};
+
+// Fixed settings that keep every stage busy; the sweep signal moves
+// threshold, ratio and gain across their ranges instead
+inline Settings settingsAt(const Signal &signal, double position) {
+  Settings p;
+  p.threshold = -24.0f;
+  p.ratio = 4.0f;
+  p.attack = 5.0f;
+  p.release = 80.0f;
+  p.gain = 6.0f;
+
+  if (signal.sweepParameters) {
+    p.threshold = (float)juce::jmap(position, -40.0, 0.0);
+    p.ratio = (float)juce::jmap(position, 1.0, 10.0);
+    p.gain = (float)juce::jmap(position, 0.0, 18.0);
+  }
+  return p;
+}
+
+inline juce::String caseName(const Signal &signal, double sampleRate,
+                             int blockSize, const char *module) {
+  return juce::String(signal.name) + "_" + juce::String((int)sampleRate) +
+         "_" + juce::String(blockSize) + "_" + module;
+}
+
+// Cases whose reference comes from the baseline engine rather than from the
+// reference build of this tree. The baseline compressor has no parameter
+// smoothing, so only fixed settings mean the same thing to both.
+inline bool isBaselineCase(const juce::String &module, const Signal &signal) {
+  return module == "CompressorEngine" && !signal.sweepParameters;
+}
+
+//==============================================================================
+// Reference files: 32-bit float WAV
+
+inline bool writeReference(const juce::File &file,
+                           const juce::AudioBuffer<float> &buffer,
+                           double sampleRate) {
+  file.deleteFile();
+  auto stream = file.createOutputStream();
+  if (stream == nullptr)
+    return false;
+
+  juce::WavAudioFormat wav;
+  std::unique_ptr<juce::AudioFormatWriter> writer(
+      wav.createWriterFor(stream.get(), sampleRate,
+                          (unsigned int)buffer.getNumChannels(), 32, {}, 0));
+  if (writer == nullptr)
+    return false;
+  stream.release(); // now owned by the writer
+
+  return writer->writeFromAudioSampleBuffer(buffer, 0, buffer.getNumSamples());
+}
+
+inline bool readReference(const juce::File &file,
+                          juce::AudioBuffer<float> &buffer) {
+  juce::WavAudioFormat wav;
+  std::unique_ptr<juce::AudioFormatReader> reader(
+      wav.createReaderFor(file.createInputStream().release(), true));
+  if (reader == nullptr)
+    return false;
+
+  buffer.setSize((int)reader->numChannels, (int)reader->lengthInSamples);
+  return reader->read(&buffer, 0, buffer.getNumSamples(), 0, true, true);
+}
+
+} // namespace golden
@@ -0,0 +1,281 @@
+// Golden-render regression harness.
+//
+// Renders a fixed set of test signals through each DSP module and the full
+// chain, at several sample rates and block sizes, and either stores the
+// results as references or compares against stored ones.
+//
+//   EA_PURE_COMPRESSOR_Golden --generate=<dir>   write references
+//   EA_PURE_COMPRESSOR_Golden --check=<dir>      compare, exit 1 on failure
+//       [--filter=<text>]   only cases whose name contains text
+//       [--verbose]         print passing cases too
+//
+// References come from two generators writing into the same directory:
+//
+// - EA_PURE_COMPRESSOR_GoldenBaseline renders the compressor cases with
+//   fixed settings through the pre-optimization engine, built from a pinned
+//   commit (EA_PURE_COMPRESSOR_GOLDEN_BASELINE). It shares no DSP code with
+//   this tree, so it catches changes to code both builds would share.
+// - The reference build, EA_PURE_COMPRESSOR_GoldenReference (same source,
+//   exact std::log2/std::exp2, staged chain, float), writes every other
+//   case: modules and behaviour the baseline doesn't have (lookahead,
+//   oversampling, multiband, the per-sample CoreProtect ratio, parameter
+//   ramps).
+//
+// The check renders every case through the optimized paths (fast math if
+// enabled, fused tiles) in both float and double. It compares the result to
+// the reference with a per-module tolerance on the peak absolute error.
+//
+// Signals: sine, tone bursts, modulated noise, synthetic drums and a
+// parameter sweep, one second of stereo each (see GoldenCases.h).
+// Everything is seeded and deterministic.
+
+#include "DSP/ProcessingChain.h"
+#include "GoldenCases.h"
+#include <JuceHeader.h>
+#include <iostream>
+
+namespace {
+
+#ifndef EA_PURE_COMPRESSOR_REFERENCE_BUILD
+#define EA_PURE_COMPRESSOR_REFERENCE_BUILD 0
+#endif
+
+using namespace golden;
+
+ChainParameters toChainParameters(const Settings &settings) {
+  ChainParameters p;
+  p.threshold = settings.threshold;
+  p.ratio = settings.ratio;
+  p.attack = settings.attack;
+  p.release = settings.release;
+  p.gain = settings.gain;
+  return p;
+}
+
+//==============================================================================
+// Modules under test
+
+struct Module {
+  const char *name;
+  // Peak absolute error allowed against the reference, in dBFS
+  double toleranceDB;
+};
+
+// CompressorEngine: fast log2/exp2 are within 0.0004 dB of exact, i.e. a
+// relative error under 5e-5. CoreProtect's ratio curve and the saturation
+// only see float/double rounding. The chain adds the errors up.
+const Module modules[] = {
+    {"CompressorEngine", -80.0},
+    {"CompressorEngine-lookahead", -80.0},
+    {"CoreProtect", -90.0},
+    {"CrystallineSaturation-1x", -90.0},
+    {"CrystallineSaturation-4x", -90.0},
+    {"MultibandCompressor", -80.0},
+    {"ProcessingChain", -80.0},
+};
+
+// Renders input through one module in host-sized blocks. Output is the
+// processed audio, or for CoreProtect the per-sample ratio (mono).
+template <typename SampleType>
+juce::AudioBuffer<float> render(const Module &module, const Signal &signal,
+                                const juce::AudioBuffer<float> &input,
+                                double sampleRate, int blockSize,
+                                bool staged) {
+  auto numSamples = input.getNumSamples();
+  juce::String name(module.name);
+
+  juce::AudioBuffer<SampleType> audio(numChannels, numSamples);
+  for (int ch = 0; ch < numChannels; ++ch)
+    for (int i = 0; i < numSamples; ++i)
+      audio.setSample(ch, i, (SampleType)input.getSample(ch, i));
+
+  juce::AudioBuffer<float> ratios(1, numSamples);
+
+  CompressorEngine<SampleType> engine;
+  CoreProtect<SampleType> coreProtect;
+  CrystallineSaturation<SampleType> saturation;
+  MultibandCompressor<SampleType> multiband;
+  ProcessingChain<SampleType> chain;
+
+  engine.prepare(sampleRate, blockSize, numChannels);
+  engine.setLookahead(name.endsWith("lookahead") ? 5.0f : 0.0f);
+  coreProtect.prepare(sampleRate, blockSize, numChannels);
+  saturation.prepare(sampleRate, blockSize, numChannels);
+  saturation.setOversampling(name.endsWith("4x") ? 2 : 0);
+  multiband.prepare(sampleRate, blockSize, numChannels);
+  chain.prepare(sampleRate, blockSize, numChannels);
+
+  for (int start = 0; start < numSamples; start += blockSize) {
+    auto n = juce::jmin(blockSize, numSamples - start);
+    auto p = toChainParameters(settingsAt(signal, (double)start / numSamples));
+    juce::AudioBuffer<SampleType> block(audio.getArrayOfWritePointers(),
+                                        numChannels, start, n);
+
+    if (name.startsWith("CompressorEngine")) {
+      engine.process(block, p.threshold, p.ratio, p.attack, p.release);
+    } else if (name == "CoreProtect") {
+      const auto *r = coreProtect.process(block, p.ratio);
+      ratios.copyFrom(0, start, r, n);
+    } else if (name == "MultibandCompressor") {
+      // Each band a little harder than the one below
+      typename MultibandCompressor<SampleType>::Bands bands;
+      for (size_t b = 0; b < bands.size(); ++b)
+        bands[b] = {p.threshold - 6.0f * (float)b, p.ratio + (float)b};
+      multiband.process(block, bands, p.attack, p.release);
+    } else if (name.startsWith("CrystallineSaturation")) {
+      saturation.process(block, p.gain);
+    } else {
+      chain.process(block, p, nullptr,
+                    staged ? blockSize
+                           : ProcessingChain<SampleType>::defaultTileSize);
+    }
+  }
+
+  if (name == "CoreProtect")
+    return ratios;
+
+  juce::AudioBuffer<float> output(numChannels, numSamples);
+  for (int ch = 0; ch < numChannels; ++ch)
+    for (int i = 0; i < numSamples; ++i)
+      output.setSample(ch, i, (float)audio.getSample(ch, i));
+  return output;
+}
+
+// Peak absolute difference in dBFS (-200 for identical)
+double peakErrorDB(const juce::AudioBuffer<float> &a,
+                   const juce::AudioBuffer<float> &b) {
+  if (a.getNumChannels() != b.getNumChannels() ||
+      a.getNumSamples() != b.getNumSamples())
+    return 0.0;
+
+  float peak = 0.0f;
+  for (int ch = 0; ch < a.getNumChannels(); ++ch) {
+    const auto *x = a.getReadPointer(ch);
+    const auto *y = b.getReadPointer(ch);
+    for (int i = 0; i < a.getNumSamples(); ++i)
+      peak = std::max(peak, std::abs(x[i] - y[i]));
+  }
+  return juce::Decibels::gainToDecibels(peak, -200.0f);
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  juce::ScopedJuceInitialiser_GUI juceInit;
+
+  juce::File directory;
+  juce::String filter;
+  bool generate = false, verbose = false;
+
+  for (int i = 1; i < argc; ++i) {
+    juce::String arg(argv[i]);
+    auto name = arg.upToFirstOccurrenceOf("=", false, false);
+    auto value = arg.fromFirstOccurrenceOf("=", false, false);
+
+    if (name == "--generate" || name == "--check") {
+      generate = name == "--generate";
+      directory = juce::File::getCurrentWorkingDirectory().getChildFile(value);
+    } else if (name == "--filter") {
+      filter = value;
+    } else if (name == "--verbose") {
+      verbose = true;
+    } else {
+      directory = juce::File();
+      break;
+    }
+  }
+
+  if (directory == juce::File()) {
+    std::cerr << "usage: EA_PURE_COMPRESSOR_Golden --generate=<dir> | "
+                 "--check=<dir> [--filter=<text>] [--verbose]"
+              << std::endl;
+    return 1;
+  }
+
+  if (generate && !EA_PURE_COMPRESSOR_REFERENCE_BUILD)
+    std::cerr << "warning: generating from an optimized build; use "
+                 "EA_PURE_COMPRESSOR_GoldenReference for references"
+              << std::endl;
+
+  if (generate && !directory.createDirectory()) {
+    std::cerr << "Cannot create " << directory.getFullPathName() << std::endl;
+    return 1;
+  }
+
+  int numCases = 0, numFailed = 0;
+
+  for (auto &signal : signals)
+    for (auto sampleRate : sampleRates)
+      for (auto blockSize : blockSizes) {
+        juce::AudioBuffer<float> input(numChannels, (int)sampleRate);
+        input.clear();
+        signal.generate(input, sampleRate);
+
+        for (auto &module : modules) {
+          auto name = caseName(signal, sampleRate, blockSize, module.name);
+          if (filter.isNotEmpty() && !name.contains(filter))
+            continue;
+
+          auto file = directory.getChildFile(name + ".wav");
+          auto fromBaseline = isBaselineCase(module.name, signal);
+
+          if (generate) {
+            // Written by EA_PURE_COMPRESSOR_GoldenBaseline instead
+            if (fromBaseline)
+              continue;
+
+            auto reference = render<float>(module, signal, input, sampleRate,
+                                           blockSize, true);
+            if (!writeReference(file, reference, sampleRate)) {
+              std::cerr << "Cannot write " << file.getFullPathName()
+                        << std::endl;
+              return 1;
+            }
+            ++numCases;
+            continue;
+          }
+
+          juce::AudioBuffer<float> reference;
+          if (!readReference(file, reference)) {
+            std::cout << "MISSING " << name
+                      << (fromBaseline ? " (from GoldenBaseline)" : "")
+                      << std::endl;
+            ++numFailed;
+            continue;
+          }
+
+          // Optimized paths: fused tiles, in both precisions
+          const std::pair<const char *, juce::AudioBuffer<float>> results[] = {
+              {"float", render<float>(module, signal, input, sampleRate,
+                                      blockSize, false)},
+              {"double", render<double>(module, signal, input, sampleRate,
+                                        blockSize, false)},
+          };
+
+          for (auto &[precision, result] : results) {
+            auto errorDB = peakErrorDB(reference, result);
+            auto passed = errorDB <= module.toleranceDB;
+            ++numCases;
+            if (!passed)
+              ++numFailed;
+
+            if (!passed || verbose)
+              std::cout << (passed ? "PASS " : "FAIL ") << name << " "
+                        << precision << (fromBaseline ? " vs baseline" : "")
+                        << ": peak error " << juce::String(errorDB, 1)
+                        << " dBFS (limit " << module.toleranceDB << ")"
+                        << std::endl;
+          }
+        }
+      }
+
+  if (generate) {
+    std::cout << "Wrote " << numCases << " references to "
+              << directory.getFullPathName() << std::endl;
+    return 0;
+  }
+
+  std::cout << numCases - numFailed << "/" << numCases << " passed"
+            << std::endl;
+  return numFailed == 0 ? 0 : 1;
+}
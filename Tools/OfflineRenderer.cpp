@@ -0,0 +1,320 @@
+// Headless batch renderer.
+//
+// Streams WAV/AIFF files through EaPureCompressorAudioProcessor exactly as a
+// host would, one processor instance per file. Reading is prefetched by a
+// BufferingAudioReader and writing is drained by a ThreadedWriter, both on
+// shared background threads, so disk I/O overlaps the DSP. Files are spread
+// over a thread pool.
+//
+//   EA_PURE_COMPRESSOR_Render [options] <input files...>
+//
+//   --out=<dir>         write results here (default: next to the input,
+//                       with an "_ea" suffix)
+//   --state=<file>      load parameters from a saved state blob
+//   --save-state=<file> write the resolved parameter state and exit
+//   --<paramID>=<value> set a parameter, e.g. --threshold=-18 --ratio=4
+//   --block=<n>         host block size (default 512)
+//   --jobs=<n>          files rendered in parallel (default: CPU cores)
+
+#include "PluginProcessor.h"
+#include <JuceHeader.h>
+#include <iostream>
+
+namespace {
+
+struct RenderSettings {
+  juce::File outputDir;
+  juce::MemoryBlock state;
+  juce::StringPairArray parameterValues;
+  int blockSize = 512;
+};
+
+juce::CriticalSection consoleLock;
+
+void printLine(const juce::String &message, bool isError = false) {
+  const juce::ScopedLock sl(consoleLock);
+  (isError ? std::cerr : std::cout) << message << std::endl;
+}
+
+// Applies the saved state blob, then any --paramID=value overrides
+bool applyParameters(EaPureCompressorAudioProcessor &processor,
+                     const RenderSettings &settings, juce::String &error) {
+  if (settings.state.getSize() > 0)
+    processor.setStateInformation(settings.state.getData(),
+                                  (int)settings.state.getSize());
+
+  for (auto &id : settings.parameterValues.getAllKeys()) {
+    auto *param = processor.apvts.getParameter(id);
+    if (param == nullptr) {
+      error = "Unknown parameter: " + id;
+      return false;
+    }
+
+    auto value = settings.parameterValues[id].getFloatValue();
+    param->setValueNotifyingHost(param->convertTo0to1(value));
+  }
+
+  return true;
+}
+
+class RenderJob : public juce::ThreadPoolJob {
+public:
+  RenderJob(const juce::File &in, const juce::File &out,
+            const RenderSettings &s, juce::TimeSliceThread &readThread,
+            juce::TimeSliceThread &writeThread, std::atomic<int> &failures)
+      : juce::ThreadPoolJob(in.getFileName()), inputFile(in), outputFile(out),
+        settings(s), readerThread(readThread), writerThread(writeThread),
+        failureCount(failures) {}
+
+  JobStatus runJob() override {
+    juce::String error;
+    if (!render(error)) {
+      printLine(inputFile.getFullPathName() + ": " + error, true);
+      ++failureCount;
+    } else {
+      printLine(inputFile.getFileName() + " -> " +
+                outputFile.getFullPathName());
+    }
+    return jobHasFinished;
+  }
+
+private:
+  bool render(juce::String &error) {
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+
+    std::unique_ptr<juce::AudioFormatReader> fileReader(
+        formatManager.createReaderFor(inputFile));
+    if (fileReader == nullptr) {
+      error = "not a readable WAV/AIFF file";
+      return false;
+    }
+
+    auto numChannels = (int)fileReader->numChannels;
+    auto sampleRate = fileReader->sampleRate;
+    auto lengthInSamples = fileReader->lengthInSamples;
+    auto bitsPerSample = (int)fileReader->bitsPerSample;
+    auto blockSize = settings.blockSize;
+
+    auto *format = formatManager.findFormatForFileExtension(
+        outputFile.getFileExtension());
+    if (format == nullptr) {
+      error = "no writer for " + outputFile.getFileExtension();
+      return false;
+    }
+
+    // Set up the processor as a host would
+    EaPureCompressorAudioProcessor processor;
+    processor.setNonRealtime(true);
+    processor.setPlayConfigDetails(numChannels, numChannels, sampleRate,
+                                   blockSize);
+    if (processor.getTotalNumInputChannels() != numChannels) {
+      error = juce::String(numChannels) + " channels are not supported";
+      return false;
+    }
+
+    if (!applyParameters(processor, settings, error))
+      return false;
+
+    processor.prepareToPlay(sampleRate, blockSize);
+
+    // Prefetch the input on the shared read thread
+    juce::BufferingAudioReader reader(fileReader.release(), readerThread,
+                                      blockSize * 16);
+    reader.setReadTimeout(-1);
+
+    outputFile.deleteFile();
+    auto outStream = outputFile.createOutputStream();
+    if (outStream == nullptr) {
+      error = "cannot write " + outputFile.getFullPathName();
+      return false;
+    }
+
+    std::unique_ptr<juce::AudioFormatWriter> fileWriter(
+        format->createWriterFor(outStream.get(), sampleRate,
+                                (unsigned int)numChannels, bitsPerSample, {},
+                                0));
+    if (fileWriter == nullptr) {
+      error = "cannot create a " + format->getFormatName() + " writer";
+      return false;
+    }
+    outStream.release(); // now owned by the writer
+
+    // Drain the output on the shared write thread
+    juce::AudioFormatWriter::ThreadedWriter writer(
+        fileWriter.release(), writerThread, blockSize * 16);
+
+    juce::AudioBuffer<float> buffer(numChannels, blockSize);
+    juce::MidiBuffer midi;
+    std::vector<const float *> outChannels((size_t)numChannels);
+
+    // Drop the processor's latency from the start of the output and flush
+    // the same amount of tail at the end so the render stays time-aligned
+    auto latency = (juce::int64)processor.getLatencySamples();
+    auto samplesToSkip = latency;
+    auto totalToProcess = lengthInSamples + latency;
+
+    for (juce::int64 pos = 0; pos < totalToProcess; pos += blockSize) {
+      auto numSamples = (int)juce::jmin((juce::int64)blockSize,
+                                        totalToProcess - pos);
+      auto numFromFile = (int)juce::jlimit(
+          (juce::int64)0, (juce::int64)numSamples, lengthInSamples - pos);
+
+      buffer.clear();
+      if (numFromFile > 0)
+        reader.read(&buffer, 0, numFromFile, pos, true, true);
+
+      juce::AudioBuffer<float> block(buffer.getArrayOfWritePointers(),
+                                     numChannels, numSamples);
+      processor.processBlock(block, midi);
+
+      auto skip = (int)juce::jmin(samplesToSkip, (juce::int64)numSamples);
+      samplesToSkip -= skip;
+
+      if (skip < numSamples) {
+        for (int ch = 0; ch < numChannels; ++ch)
+          outChannels[(size_t)ch] = block.getReadPointer(ch, skip);
+
+        while (!writer.write(outChannels.data(), numSamples - skip))
+          juce::Thread::sleep(1);
+      }
+    }
+
+    processor.releaseResources();
+    return true;
+  }
+
+  juce::File inputFile, outputFile;
+  const RenderSettings &settings;
+  juce::TimeSliceThread &readerThread, &writerThread;
+  std::atomic<int> &failureCount;
+};
+
+juce::File getOutputFileFor(const juce::File &input,
+                            const RenderSettings &settings) {
+  if (settings.outputDir != juce::File())
+    return settings.outputDir.getChildFile(input.getFileName());
+
+  return input.getSiblingFile(input.getFileNameWithoutExtension() + "_ea" +
+                              input.getFileExtension());
+}
+
+void printUsage() {
+  std::cout
+      << "usage: EA_PURE_COMPRESSOR_Render [options] <input files...>\n"
+         "  --out=<dir>          output directory (default: <name>_ea.<ext>)\n"
+         "  --state=<file>       load parameters from a saved state blob\n"
+         "  --save-state=<file>  write the resolved state blob and exit\n"
+         "  --<paramID>=<value>  set a parameter, e.g. --threshold=-18\n"
+         "  --block=<n>          host block size (default 512)\n"
+         "  --jobs=<n>           files rendered in parallel\n";
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  juce::ScopedJuceInitialiser_GUI juceInit;
+
+  RenderSettings settings;
+  juce::File saveStateFile;
+  juce::Array<juce::File> inputs;
+  auto numJobs = juce::SystemStats::getNumCpus();
+
+  for (int i = 1; i < argc; ++i) {
+    juce::String arg(argv[i]);
+
+    if (!arg.startsWith("--")) {
+      inputs.add(juce::File::getCurrentWorkingDirectory().getChildFile(arg));
+      continue;
+    }
+
+    auto name = arg.substring(2).upToFirstOccurrenceOf("=", false, false);
+    auto value = arg.fromFirstOccurrenceOf("=", false, false);
+
+    if (name == "help") {
+      printUsage();
+      return 0;
+    } else if (name == "out") {
+      settings.outputDir =
+          juce::File::getCurrentWorkingDirectory().getChildFile(value);
+    } else if (name == "state") {
+      auto stateFile =
+          juce::File::getCurrentWorkingDirectory().getChildFile(value);
+      if (!stateFile.loadFileAsData(settings.state)) {
+        printLine("Cannot read " + stateFile.getFullPathName(), true);
+        return 1;
+      }
+    } else if (name == "save-state") {
+      saveStateFile =
+          juce::File::getCurrentWorkingDirectory().getChildFile(value);
+    } else if (name == "block") {
+      settings.blockSize = juce::jmax(1, value.getIntValue());
+    } else if (name == "jobs") {
+      numJobs = juce::jmax(1, value.getIntValue());
+    } else {
+      settings.parameterValues.set(name, value);
+    }
+  }
+
+  // Validate the parameters once up front rather than once per file
+  {
+    EaPureCompressorAudioProcessor processor;
+    juce::String error;
+    if (!applyParameters(processor, settings, error)) {
+      printLine(error, true);
+      return 1;
+    }
+
+    if (saveStateFile != juce::File()) {
+      juce::MemoryBlock state;
+      processor.getStateInformation(state);
+      if (!saveStateFile.replaceWithData(state.getData(), state.getSize())) {
+        printLine("Cannot write " + saveStateFile.getFullPathName(), true);
+        return 1;
+      }
+      printLine("Saved state to " + saveStateFile.getFullPathName());
+      return 0;
+    }
+  }
+
+  if (inputs.isEmpty()) {
+    printUsage();
+    return 1;
+  }
+
+  if (settings.outputDir != juce::File())
+    settings.outputDir.createDirectory();
+
+  juce::TimeSliceThread readThread("EA render read");
+  juce::TimeSliceThread writeThread("EA render write");
+  readThread.startThread();
+  writeThread.startThread();
+
+  std::atomic<int> failures{0};
+
+  {
+    juce::ThreadPool pool(numJobs);
+
+    for (auto &input : inputs) {
+      auto output = getOutputFileFor(input, settings);
+      if (output == input) {
+        printLine(input.getFullPathName() + ": refusing to overwrite the input",
+            true);
+        ++failures;
+        continue;
+      }
+
+      pool.addJob(new RenderJob(input, output, settings, readThread,
+                                writeThread, failures),
+                  true);
+    }
+
+    while (pool.getNumJobs() > 0)
+      juce::Thread::sleep(10);
+  }
+
+  readThread.stopThread(1000);
+  writeThread.stopThread(1000);
+
+  return failures.load() == 0 ? 0 : 1;
+}
@@ -0,0 +1,306 @@
+// Real-time safety check for the audio callback.
+//
+// Drives EaPureCompressorAudioProcessor headless with randomized sample
+// rates, block sizes, precision, sidechain layout, bypass and parameter
+// changes. This target is built with EA_PURE_COMPRESSOR_REALTIME_GUARD, so
+// processBlock() runs inside a RealtimeGuard; the hooks below catch heap
+// allocation, mutex locks and blocking system calls made while the guard is
+// active and record the call stack. Exits 1 if anything was caught.
+//
+//   EA_PURE_COMPRESSOR_RealtimeCheck [--blocks=<n>] [--seed=<n>]
+//
+// Allocation is caught by the shared hooks in Tools/AllocationHooks.cpp. On
+// Linux locks and syscalls are interposed by symbol as well.
+
+// Fortified inline wrappers would clash with the read/open hooks
+#undef _FORTIFY_SOURCE
+
+#include "AllocationHooks.h"
+#include "PluginProcessor.h"
+#include "RealtimeGuard.h"
+#include <JuceHeader.h>
+#include <iostream>
+
+#if JUCE_LINUX
+#include <cstdarg>
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <unistd.h>
+#endif
+
+#if !EA_PURE_COMPRESSOR_REALTIME_GUARD
+#error "RealtimeCheck must be built with EA_PURE_COMPRESSOR_REALTIME_GUARD=1"
+#endif
+
+namespace {
+
+// What the driver was doing, copied into each report
+struct BlockContext {
+  double sampleRate = 0.0;
+  int maxBlockSize = 0, blockSize = 0;
+  juce::int64 blockIndex = 0;
+  bool isDouble = false, sidechain = false, bypassed = false;
+};
+
+BlockContext currentBlock;
+
+constexpr int maxReports = 8;
+std::atomic<int> numViolations{0};
+juce::String reports[maxReports];
+
+// Called from every hook. Cheap when no guard is active, which is almost
+// always; otherwise records what was called, from where and in which block.
+void reportViolation(const char *what) noexcept {
+  if (!RealtimeGuard::isActive())
+    return;
+
+  const RealtimeGuard::ScopedSuspend suspend;
+  auto index = numViolations++;
+  if (index >= maxReports)
+    return;
+
+  auto &c = currentBlock;
+  reports[index] =
+      juce::String(what) + " in block " + juce::String(c.blockIndex) + " (" +
+      juce::String(c.sampleRate, 0) + " Hz, " + juce::String(c.blockSize) +
+      "/" + juce::String(c.maxBlockSize) + " samples, " +
+      (c.isDouble ? "double" : "float") +
+      (c.sidechain ? ", sidechain" : "") + (c.bypassed ? ", bypassed" : "") +
+      ")\n" + juce::SystemStats::getStackBacktrace();
+}
+
+} // namespace
+
+//==============================================================================
+// Hooks
+
+void onAllocation(const char *what) noexcept { reportViolation(what); }
+
+#if JUCE_LINUX
+
+namespace {
+
+// Resolved on first use without a function-local static: the guard for
+// one could itself take a lock
+template <typename Function>
+Function nextSymbol(Function &cache, const char *name) {
+  if (cache == nullptr)
+    cache = reinterpret_cast<Function>(dlsym(RTLD_NEXT, name));
+  return cache;
+}
+
+int (*realMutexLock)(pthread_mutex_t *);
+int (*realCondWait)(pthread_cond_t *, pthread_mutex_t *);
+int (*realCondTimedWait)(pthread_cond_t *, pthread_mutex_t *,
+                         const timespec *);
+int (*realSemWait)(sem_t *);
+int (*realNanosleep)(const timespec *, timespec *);
+int (*realUsleep)(useconds_t);
+ssize_t (*realRead)(int, void *, size_t);
+ssize_t (*realWrite)(int, const void *, size_t);
+int (*realOpen)(const char *, int, ...);
+
+} // namespace
+
+extern "C" {
+int pthread_mutex_lock(pthread_mutex_t *mutex) noexcept {
+  reportViolation("pthread_mutex_lock");
+  return nextSymbol(realMutexLock, "pthread_mutex_lock")(mutex);
+}
+
+int pthread_cond_wait(pthread_cond_t *cond, pthread_mutex_t *mutex) {
+  reportViolation("pthread_cond_wait");
+  return nextSymbol(realCondWait, "pthread_cond_wait")(cond, mutex);
+}
+
+int pthread_cond_timedwait(pthread_cond_t *cond, pthread_mutex_t *mutex,
+                           const timespec *time) {
+  reportViolation("pthread_cond_timedwait");
+  return nextSymbol(realCondTimedWait, "pthread_cond_timedwait")(cond, mutex,
+                                                                 time);
+}
+
+int sem_wait(sem_t *sem) {
+  reportViolation("sem_wait");
+  return nextSymbol(realSemWait, "sem_wait")(sem);
+}
+
+int nanosleep(const timespec *duration, timespec *remaining) {
+  reportViolation("nanosleep");
+  return nextSymbol(realNanosleep, "nanosleep")(duration, remaining);
+}
+
+int usleep(useconds_t microseconds) {
+  reportViolation("usleep");
+  return nextSymbol(realUsleep, "usleep")(microseconds);
+}
+
+ssize_t read(int fd, void *data, size_t size) {
+  reportViolation("read");
+  return nextSymbol(realRead, "read")(fd, data, size);
+}
+
+ssize_t write(int fd, const void *data, size_t size) {
+  reportViolation("write");
+  return nextSymbol(realWrite, "write")(fd, data, size);
+}
+
+int open(const char *path, int flags, ...) {
+  reportViolation("open");
+  mode_t mode = 0;
+  if ((flags & O_CREAT) != 0) {
+    va_list args;
+    va_start(args, flags);
+    mode = (mode_t)va_arg(args, int);
+    va_end(args);
+  }
+  return nextSymbol(realOpen, "open")(path, flags, mode);
+}
+}
+
+#endif
+
+//==============================================================================
+// Driver
+
+namespace {
+
+const double sampleRates[] = {44100.0, 48000.0, 88200.0, 96000.0, 192000.0};
+const int maxBlockSizes[] = {32, 64, 256, 512, 1024, 4096};
+constexpr int blocksPerConfiguration = 500;
+
+// Mostly arbitrary sizes, with the edge cases hosts actually send
+int randomBlockSize(juce::Random &random, int maxBlockSize) {
+  auto pick = random.nextInt(10);
+  if (pick == 0)
+    return 1;
+  if (pick == 1)
+    return maxBlockSize;
+  return 1 + random.nextInt(maxBlockSize);
+}
+
+template <typename SampleType>
+void fillNoise(juce::AudioBuffer<SampleType> &buffer, juce::Random &random) {
+  // Occasional silent blocks exercise the idle path
+  auto level = random.nextInt(8) == 0 ? 0.0f : random.nextFloat();
+  for (int ch = 0; ch < buffer.getNumChannels(); ++ch) {
+    auto *data = buffer.getWritePointer(ch);
+    for (int i = 0; i < buffer.getNumSamples(); ++i)
+      data[i] = (SampleType)(level * (random.nextFloat() * 2.0f - 1.0f));
+  }
+}
+
+// Host-side automation. The JUCE wrappers do the same setValue() plus
+// listener callback, which takes JUCE's own listener lock, so it runs
+// outside the guard.
+void changeRandomParameter(EaPureCompressorAudioProcessor &processor,
+                           juce::Random &random) {
+  auto &params = processor.getParameters();
+  auto *param = params[random.nextInt(params.size())];
+  auto value = random.nextFloat();
+  param->setValue(value);
+  param->sendValueChangedMessageToListeners(value);
+}
+
+template <typename SampleType>
+void runConfiguration(EaPureCompressorAudioProcessor &processor,
+                      juce::Random &random, juce::int64 &blockIndex,
+                      juce::int64 lastBlock) {
+  auto maxBlockSize = currentBlock.maxBlockSize;
+  auto numChannels = juce::jmax(processor.getTotalNumInputChannels(),
+                                processor.getTotalNumOutputChannels());
+  juce::AudioBuffer<SampleType> buffer(numChannels, maxBlockSize);
+  juce::MidiBuffer midi;
+
+  for (int i = 0; i < blocksPerConfiguration && blockIndex < lastBlock;
+       ++i, ++blockIndex) {
+    if (random.nextInt(8) == 0)
+      changeRandomParameter(processor, random);
+
+    auto n = randomBlockSize(random, maxBlockSize);
+    juce::AudioBuffer<SampleType> block(buffer.getArrayOfWritePointers(),
+                                        numChannels, 0, n);
+    fillNoise(block, random);
+
+    currentBlock.blockIndex = blockIndex;
+    currentBlock.blockSize = n;
+    currentBlock.bypassed = random.nextInt(20) == 0;
+
+    if (currentBlock.bypassed)
+      processor.processBlockBypassed(block, midi);
+    else
+      processor.processBlock(block, midi);
+  }
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  juce::ScopedJuceInitialiser_GUI juceInit;
+
+  juce::int64 numBlocks = 20000, seed = 1;
+  for (int i = 1; i < argc; ++i) {
+    juce::String arg(argv[i]);
+    auto name = arg.upToFirstOccurrenceOf("=", false, false);
+    auto value = arg.fromFirstOccurrenceOf("=", false, false);
+
+    if (name == "--blocks") {
+      numBlocks = value.getLargeIntValue();
+    } else if (name == "--seed") {
+      seed = value.getLargeIntValue();
+    } else {
+      std::cerr << "usage: EA_PURE_COMPRESSOR_RealtimeCheck [--blocks=<n>] "
+                   "[--seed=<n>]"
+                << std::endl;
+      return 1;
+    }
+  }
+
+  juce::Random random(seed);
+  EaPureCompressorAudioProcessor processor;
+  juce::int64 blockIndex = 0;
+
+  while (blockIndex < numBlocks) {
+    // Everything a host does between prepareToPlay() calls is allowed to
+    // allocate; only processBlock() is guarded
+    auto &c = currentBlock;
+    c.sampleRate = sampleRates[random.nextInt((int)std::size(sampleRates))];
+    c.maxBlockSize =
+        maxBlockSizes[random.nextInt((int)std::size(maxBlockSizes))];
+    c.isDouble = random.nextBool();
+    c.sidechain = random.nextBool();
+
+    processor.releaseResources();
+
+    auto layout = processor.getBusesLayout();
+    if (layout.inputBuses.size() > 1) {
+      layout.inputBuses.getReference(1) =
+          c.sidechain ? juce::AudioChannelSet::stereo()
+                      : juce::AudioChannelSet::disabled();
+      processor.setBusesLayout(layout);
+    }
+
+    processor.setProcessingPrecision(
+        c.isDouble ? juce::AudioProcessor::doublePrecision
+                   : juce::AudioProcessor::singlePrecision);
+    processor.setRateAndBufferSizeDetails(c.sampleRate, c.maxBlockSize);
+    processor.prepareToPlay(c.sampleRate, c.maxBlockSize);
+
+    if (c.isDouble)
+      runConfiguration<double>(processor, random, blockIndex, numBlocks);
+    else
+      runConfiguration<float>(processor, random, blockIndex, numBlocks);
+  }
+
+  processor.releaseResources();
+
+  auto violations = numViolations.load();
+  for (int i = 0; i < juce::jmin(violations, maxReports); ++i)
+    std::cout << "VIOLATION " << reports[i] << std::endl;
+
+  std::cout << violations << " real-time violations in " << numBlocks
+            << " blocks (seed " << seed << ")" << std::endl;
+  return violations == 0 ? 0 : 1;
+}
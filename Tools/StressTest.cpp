@@ -0,0 +1,350 @@
+// Multi-instance scaling stress test.
+//
+// Creates N processor instances and drives them the way a host does: every
+// cycle, T worker threads each run one block through the instances they own
+// (instance i belongs to worker i % T, the calling thread being worker 0),
+// and the cycle ends once every worker is done. Cycles run back to back
+// instead of being paced to the clock, so the numbers show the headroom.
+//
+//   EA_PURE_COMPRESSOR_Stress [--instances=1,8,32,128] [--threads=1,2,4,8]
+//                             [--block=<n>] [--rate=<hz>] [--channels=<n>]
+//                             [--seconds=<s>] [--precision=float|double]
+//                             [--out=<file.json>]
+//
+// For every instances x threads pair, after a short warm-up:
+//   realtimeFactor:     audio time processed per wall time, all instances
+//   callback p50/p99/max: a single processBlock() call
+//   cycle p50/p99/max:  all instances once, against the block's deadline
+//   misses:             cycles that took longer than the block lasts
+// Per-callback latency should stay flat as threads are added; if it climbs,
+// instances are contending on something shared (or falsely shared).
+
+#include "PluginProcessor.h"
+#include <JuceHeader.h>
+#include <iostream>
+#include <thread>
+
+namespace {
+
+struct Settings {
+  juce::Array<int> instanceCounts{1, 8, 32, 128};
+  juce::Array<int> threadCounts{1, 2, 4, 8};
+  int blockSize = 256;
+  int numChannels = 2;
+  double sampleRate = 48000.0;
+  double seconds = 3.0;
+  bool isDouble = false;
+};
+
+constexpr int warmUpCycles = 50;
+
+// About a second of level-modulated noise shared by all instances
+// (read-only, each instance starts at its own offset)
+juce::AudioBuffer<float> makeSource(int numChannels, double sampleRate) {
+  auto length = (int)sampleRate + 8192;
+  juce::AudioBuffer<float> source(numChannels, length);
+
+  juce::Random random(1234);
+  for (int ch = 0; ch < numChannels; ++ch) {
+    auto *data = source.getWritePointer(ch);
+    for (int i = 0; i < length; ++i) {
+      auto env = 0.5f + 0.45f * std::sin(juce::MathConstants<float>::twoPi *
+                                         3.0f * (float)(i / sampleRate));
+      data[i] = env * (random.nextFloat() * 2.0f - 1.0f);
+    }
+  }
+  return source;
+}
+
+// Every parameter at a random value, so the instances between them cover
+// the modes (multiband, oversampling, lookahead, ...) a session would
+void randomiseParameters(EaPureCompressorAudioProcessor &processor,
+                         juce::Random &random) {
+  for (auto *param : processor.getParameters())
+    param->setValueNotifyingHost(random.nextFloat());
+}
+
+template <typename SampleType> struct Instance {
+  std::unique_ptr<EaPureCompressorAudioProcessor> processor;
+  juce::AudioBuffer<SampleType> block;
+  int sourcePos = 0;
+};
+
+// Instances owned by one worker, and what it measured. Cache-line aligned so
+// the workers' histograms don't falsely share with each other.
+template <typename SampleType> struct alignas(64) Worker {
+  std::vector<Instance<SampleType> *> instances;
+  LatencyHistogram callbacks;
+};
+
+template <typename SampleType>
+void processCycle(Worker<SampleType> &worker,
+                  const juce::AudioBuffer<float> &source, int blockSize,
+                  double nanosecondsPerTick) {
+  juce::MidiBuffer midi;
+
+  for (auto *instance : worker.instances) {
+    auto &block = instance->block;
+    if (instance->sourcePos + blockSize > source.getNumSamples())
+      instance->sourcePos = 0;
+    for (int ch = 0; ch < block.getNumChannels(); ++ch) {
+      const auto *src = source.getReadPointer(ch % source.getNumChannels(),
+                                              instance->sourcePos);
+      auto *dest = block.getWritePointer(ch);
+      for (int i = 0; i < blockSize; ++i)
+        dest[i] = (SampleType)src[i];
+    }
+    instance->sourcePos += blockSize;
+
+    auto start = juce::Time::getHighResolutionTicks();
+    instance->processor->processBlock(block, midi);
+    worker.callbacks.record(
+        (double)(juce::Time::getHighResolutionTicks() - start) *
+        nanosecondsPerTick);
+  }
+}
+
+template <typename SampleType>
+juce::var runConfiguration(const Settings &s, int numInstances,
+                           int numThreads,
+                           const juce::AudioBuffer<float> &source) {
+  const auto nanosecondsPerTick =
+      1.0e9 / (double)juce::Time::getHighResolutionTicksPerSecond();
+  const auto deadline = 1.0e9 * s.blockSize / s.sampleRate;
+
+  std::vector<Instance<SampleType>> instances((size_t)numInstances);
+  for (int i = 0; i < numInstances; ++i) {
+    auto &instance = instances[(size_t)i];
+    instance.processor = std::make_unique<EaPureCompressorAudioProcessor>();
+    auto &processor = *instance.processor;
+
+    juce::Random random(i + 1);
+    randomiseParameters(processor, random);
+    processor.setProcessingPrecision(
+        std::is_same_v<SampleType, double>
+            ? juce::AudioProcessor::doublePrecision
+            : juce::AudioProcessor::singlePrecision);
+    processor.setPlayConfigDetails(s.numChannels, s.numChannels, s.sampleRate,
+                                   s.blockSize);
+    processor.prepareToPlay(s.sampleRate, s.blockSize);
+
+    auto numChannels = juce::jmax(processor.getTotalNumInputChannels(),
+                                  processor.getTotalNumOutputChannels());
+    instance.block.setSize(numChannels, s.blockSize);
+    instance.sourcePos =
+        random.nextInt(juce::jmax(1, source.getNumSamples() - s.blockSize));
+  }
+
+  std::vector<Worker<SampleType>> workers((size_t)numThreads);
+  for (int i = 0; i < numInstances; ++i)
+    workers[(size_t)(i % numThreads)].instances.push_back(
+        &instances[(size_t)i]);
+
+  // Workers spin (yielding) on the cycle counter like a host's audio
+  // threads waiting for the next callback, and count themselves off
+  std::atomic<int> cycle{0}, remaining{0};
+  std::atomic<bool> quit{false};
+
+  std::vector<std::thread> threads;
+  for (int t = 1; t < numThreads; ++t)
+    threads.emplace_back([&, t] {
+      int seen = 0;
+      for (;;) {
+        int current;
+        while ((current = cycle.load(std::memory_order_acquire)) == seen)
+          std::this_thread::yield();
+        if (quit.load(std::memory_order_acquire))
+          return;
+        seen = current;
+
+        processCycle(workers[(size_t)t], source, s.blockSize,
+                     nanosecondsPerTick);
+        remaining.fetch_sub(1, std::memory_order_acq_rel);
+      }
+    });
+
+  LatencyHistogram cycles;
+  juce::int64 numCycles = 0, misses = 0;
+
+  auto runCycle = [&] {
+    auto start = juce::Time::getHighResolutionTicks();
+    remaining.store(numThreads - 1, std::memory_order_relaxed);
+    cycle.fetch_add(1, std::memory_order_acq_rel);
+
+    processCycle(workers[0], source, s.blockSize, nanosecondsPerTick);
+    while (remaining.load(std::memory_order_acquire) > 0)
+      std::this_thread::yield();
+
+    return (double)(juce::Time::getHighResolutionTicks() - start) *
+           nanosecondsPerTick;
+  };
+
+  for (int i = 0; i < warmUpCycles; ++i)
+    runCycle();
+
+  // Workers are idle between cycles, so resetting here is safe
+  for (auto &worker : workers)
+    worker.callbacks.reset();
+
+  auto start = juce::Time::getHighResolutionTicks();
+  auto end = start + juce::Time::secondsToHighResolutionTicks(s.seconds);
+  auto now = start;
+  do {
+    auto ns = runCycle();
+    cycles.record(ns);
+    misses += ns > deadline ? 1 : 0;
+    ++numCycles;
+    now = juce::Time::getHighResolutionTicks();
+  } while (now < end);
+
+  quit.store(true, std::memory_order_release);
+  cycle.fetch_add(1, std::memory_order_acq_rel);
+  for (auto &thread : threads)
+    thread.join();
+
+  // Merge the workers' callback histograms
+  LatencyHistogram::Snapshot callbacks;
+  for (auto &worker : workers) {
+    auto w = worker.callbacks.getSnapshot();
+    for (int i = 0; i < LatencyHistogram::numBuckets; ++i)
+      callbacks.counts[(size_t)i] += w.counts[(size_t)i];
+    callbacks.total += w.total;
+    callbacks.maxNanoseconds =
+        juce::jmax(callbacks.maxNanoseconds, w.maxNanoseconds);
+  }
+  auto c = cycles.getSnapshot();
+
+  auto wallSeconds = juce::Time::highResolutionTicksToSeconds(now - start);
+  auto audioSeconds =
+      (double)numCycles * numInstances * s.blockSize / s.sampleRate;
+  auto realtimeFactor = wallSeconds > 0.0 ? audioSeconds / wallSeconds : 0.0;
+
+  auto *result = new juce::DynamicObject();
+  result->setProperty("instances", numInstances);
+  result->setProperty("threads", numThreads);
+  result->setProperty("cycles", numCycles);
+  result->setProperty("realtimeFactor", realtimeFactor);
+  result->setProperty("deadlineUs", deadline * 0.001);
+  result->setProperty("callbackP50Us", callbacks.getPercentile(0.5) * 0.001);
+  result->setProperty("callbackP99Us", callbacks.getPercentile(0.99) * 0.001);
+  result->setProperty("callbackMaxUs", callbacks.maxNanoseconds * 0.001);
+  result->setProperty("cycleP50Us", c.getPercentile(0.5) * 0.001);
+  result->setProperty("cycleP99Us", c.getPercentile(0.99) * 0.001);
+  result->setProperty("cycleMaxUs", c.maxNanoseconds * 0.001);
+  result->setProperty("misses", misses);
+  result->setProperty("missPercent",
+                      numCycles > 0 ? 100.0 * misses / numCycles : 0.0);
+
+  auto us = [](double ns) { return juce::String(ns * 0.001, 1); };
+  std::cout << juce::String(numInstances).paddedLeft(' ', 9)
+            << juce::String(numThreads).paddedLeft(' ', 8)
+            << juce::String(realtimeFactor, 1).paddedLeft(' ', 10)
+            << (us(callbacks.getPercentile(0.5)) + " / " +
+                us(callbacks.getPercentile(0.99)) + " / " +
+                us(callbacks.maxNanoseconds))
+                   .paddedLeft(' ', 28)
+            << (us(c.getPercentile(0.5)) + " / " + us(c.getPercentile(0.99)) +
+                " / " + us(c.maxNanoseconds))
+                   .paddedLeft(' ', 28)
+            << (juce::String(misses) + " (" +
+                juce::String(numCycles > 0 ? 100.0 * misses / numCycles : 0.0,
+                             2) +
+                "%)")
+                   .paddedLeft(' ', 16)
+            << std::endl;
+
+  return juce::var(result);
+}
+
+juce::Array<int> parseList(const juce::String &value) {
+  juce::Array<int> list;
+  for (auto &item : juce::StringArray::fromTokens(value, ",", ""))
+    if (item.getIntValue() > 0)
+      list.add(item.getIntValue());
+  return list;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  juce::ScopedJuceInitialiser_GUI juceInit;
+
+  Settings s;
+  juce::File outFile;
+
+  for (int i = 1; i < argc; ++i) {
+    juce::String arg(argv[i]);
+    auto name = arg.upToFirstOccurrenceOf("=", false, false);
+    auto value = arg.fromFirstOccurrenceOf("=", false, false);
+
+    if (name == "--instances")
+      s.instanceCounts = parseList(value);
+    else if (name == "--threads")
+      s.threadCounts = parseList(value);
+    else if (name == "--block")
+      s.blockSize = juce::jlimit(1, 8192, value.getIntValue());
+    else if (name == "--rate")
+      s.sampleRate = juce::jmax(8000.0, value.getDoubleValue());
+    else if (name == "--channels")
+      s.numChannels = juce::jmax(1, value.getIntValue());
+    else if (name == "--seconds")
+      s.seconds = juce::jmax(0.1, value.getDoubleValue());
+    else if (name == "--precision")
+      s.isDouble = value == "double";
+    else if (name == "--out")
+      outFile = juce::File::getCurrentWorkingDirectory().getChildFile(value);
+    else {
+      std::cerr << "usage: EA_PURE_COMPRESSOR_Stress "
+                   "[--instances=1,8,32,128] [--threads=1,2,4,8] "
+                   "[--block=<n>] [--rate=<hz>] [--channels=<n>] "
+                   "[--seconds=<s>] [--precision=float|double] "
+                   "[--out=<file.json>]"
+                << std::endl;
+      return 1;
+    }
+  }
+
+  auto source = makeSource(s.numChannels, s.sampleRate);
+  juce::Array<juce::var> results;
+
+  std::cout << "block " << s.blockSize << " @ " << s.sampleRate << " Hz, "
+            << s.numChannels << " ch, "
+            << (s.isDouble ? "double" : "float") << ", deadline "
+            << juce::String(1.0e6 * s.blockSize / s.sampleRate, 1) << " us, "
+            << std::thread::hardware_concurrency() << " hardware threads\n"
+            << "instances threads  realtime"
+            << juce::String("callback p50/p99/max us").paddedLeft(' ', 28)
+            << juce::String("cycle p50/p99/max us").paddedLeft(' ', 28)
+            << juce::String("misses").paddedLeft(' ', 16) << std::endl;
+
+  for (auto numInstances : s.instanceCounts)
+    for (auto numThreads : s.threadCounts) {
+      // Idle workers would only add wake-up noise
+      if (numThreads > numInstances)
+        continue;
+      results.add(s.isDouble ? runConfiguration<double>(s, numInstances,
+                                                        numThreads, source)
+                             : runConfiguration<float>(s, numInstances,
+                                                       numThreads, source));
+    }
+
+  if (outFile != juce::File()) {
+    auto *report = new juce::DynamicObject();
+    report->setProperty("date", juce::Time::getCurrentTime().toISO8601(true));
+    report->setProperty("blockSize", s.blockSize);
+    report->setProperty("sampleRate", s.sampleRate);
+    report->setProperty("channels", s.numChannels);
+    report->setProperty("precision", s.isDouble ? "double" : "float");
+    report->setProperty("hardwareThreads",
+                        (int)std::thread::hardware_concurrency());
+    report->setProperty("results", results);
+
+    if (!outFile.replaceWithText(juce::JSON::toString(juce::var(report)))) {
+      std::cerr << "error: can't write " << outFile.getFullPathName()
+                << std::endl;
+      return 1;
+    }
+  }
+
+  return 0;
+}